@@ -11,22 +11,106 @@
 #include <pangolin/resource-manager.hpp>
 
 #include <breakout/game.hpp> 
+#include <breakout/simulation.hpp>
+#include <breakout/session.hpp>
+#include <breakout/frame-pacer.hpp>
+#include <breakout/dynamic-resolution.hpp>
+#include <breakout/file-watcher.hpp>
+#include <breakout/frame-capture.hpp>
+#include <breakout/latency-probe.hpp>
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
 
 // GLFW function declerations
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+void window_refresh_callback(GLFWwindow* window);
 
 // The Width of the screen
 const unsigned int SCREEN_WIDTH = 800;
 // The height of the screen
 const unsigned int SCREEN_HEIGHT = 600;
+// Fixed rate of the simulation thread, in ticks per second
+const double SIMULATION_RATE = 120.0;
+// Frame rate cap when the monitor doesn't report its refresh rate
+const double DEFAULT_FRAME_RATE = 60.0;
+// While the scene is still, the loop sleeps in glfwWaitEventsTimeout and
+// wakes this often to look for changes made by the simulation (s)
+const double IDLE_POLL = 0.05;
+// Frames keep being paced normally this long after an input, until the
+// simulation has applied it (s)
+const double INPUT_GRACE = 0.25;
+// Lowest resolution scale the dynamic resolution controller may pick
+const float MIN_DYNAMIC_SCALE = 0.5f;
 
 Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
 
+// --record: key events of this run, saved as a session on exit
+const char* record_file = nullptr;
+Session     recording;
+double      recording_start = 0.0;
+
+// render loop: time of the last key event, and whether the window contents
+// were damaged and need drawing even though the scene didn't change
+double last_input   = 0.0;
+bool   force_redraw = true;
+// key event latencies, shown over the game with F3 or --latency
+const LatencyHistogram* latency_histogram = nullptr;
+
 int main(int argc, char *argv[]) {
 
+  // command line options
+  // --------------------
+  // frame rate cap, 0 for vsync only; defaults to the monitor's refresh rate
+  double frame_rate = -1.0;
+  // window size in screen coordinates; the game itself stays 800x600
+  unsigned int window_width = SCREEN_WIDTH, window_height = SCREEN_HEIGHT;
+  // GPU time per frame to hold by lowering the scene resolution, 0 for off (ms)
+  double frame_budget = 0.0;
+  // reload levels and shaders when their files are saved
+  bool hot_reload = false;
+  // save every presented frame into this directory
+  const char* capture_directory = nullptr;
+  // show the latency overlay from the start; save the histogram on exit
+  bool latency_overlay = false;
+  const char* latency_file = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+      Breakout.endless_seed = std::strtoull(argv[++i], nullptr, 0);
+    else if (std::strcmp(argv[i], "--autopilot") == 0)
+      Breakout.autopilot = true;
+    else if (std::strcmp(argv[i], "--fixed-point") == 0)
+      Breakout.fixed_point = true;
+    else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+      record_file = argv[++i];
+    else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+      frame_rate = std::atof(argv[++i]);
+    else if (std::strcmp(argv[i], "--window") == 0 && i + 1 < argc)
+      std::sscanf(argv[++i], "%ux%u", &window_width, &window_height);
+    else if (std::strcmp(argv[i], "--msaa") == 0 && i + 1 < argc)
+      Breakout.msaa_samples = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--scale") == 0 && i + 1 < argc)
+      Breakout.render_scale = std::atof(argv[++i]);
+    else if (std::strcmp(argv[i], "--frame-budget") == 0 && i + 1 < argc)
+      frame_budget = std::atof(argv[++i]);
+    else if (std::strcmp(argv[i], "--hot-reload") == 0)
+      hot_reload = true;
+    else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+      capture_directory = argv[++i];
+    else if (std::strcmp(argv[i], "--latency") == 0)
+      latency_overlay = true;
+    else if (std::strcmp(argv[i], "--latency-csv") == 0 && i + 1 < argc)
+      latency_file = argv[++i];
+    else if (std::strcmp(argv[i], "--shader-cache") == 0 && i + 1 < argc)
+      Breakout.shader_cache_directory = argv[++i];
+    else if (std::strcmp(argv[i], "--no-shader-cache") == 0)
+      Breakout.shader_cache_directory.clear();
+  }
+
   glfwInit();
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -35,8 +119,9 @@ int main(int argc, char *argv[]) {
   glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
   glfwWindowHint(GLFW_RESIZABLE, false);
+  glfwWindowHint(GLFW_SCALE_TO_MONITOR, true);
 
-  GLFWwindow* window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Breakout", nullptr, nullptr);
+  GLFWwindow* window = glfwCreateWindow(window_width, window_height, "Breakout", nullptr, nullptr);
   glfwMakeContextCurrent(window);
 
   // glad: load all OpenGL function pointers
@@ -48,10 +133,29 @@ int main(int argc, char *argv[]) {
 
   glfwSetKeyCallback(window, key_callback);
   glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+  glfwSetWindowRefreshCallback(window, window_refresh_callback);
+
+  // adaptive vsync: a frame that misses the blank is shown at once, torn,
+  // instead of waiting a whole refresh
+  // ------------------------------------------------------------------
+  if (glfwExtensionSupported("GLX_EXT_swap_control_tear")
+      || glfwExtensionSupported("WGL_EXT_swap_control_tear"))
+    glfwSwapInterval(-1);
+  else
+    glfwSwapInterval(1);
+
+  if (frame_rate < 0.0) {
+    const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    frame_rate = mode && mode->refreshRate > 0 ? mode->refreshRate : DEFAULT_FRAME_RATE;
+  }
 
   // OpenGL configuration
   // --------------------
-  glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+  // on high-DPI screens the framebuffer has more pixels than the window
+  int framebuffer_width, framebuffer_height;
+  glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
+  Breakout.resize_output(framebuffer_width, framebuffer_height);
+  glViewport(0, 0, framebuffer_width, framebuffer_height);
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -63,36 +167,176 @@ int main(int argc, char *argv[]) {
   // deltaTime variables
   // -------------------
   float deltaTime = 0.0f;
-  float lastFrame = 0.0f;
+  double lastFrame = glfwGetTime();
 
   // start game within menu state
   // ----------------------------
   Breakout.state = GAME_MENU;
+  // stamps key events on their way through the simulation, for the probe
+  Breakout.latency_clock = glfwGetTime;
+
+  // from here on the game state belongs to the simulation thread; this
+  // thread only polls events and renders published snapshots
+  // ------------------------------------------------------------------
+  Simulation simulation(Breakout, SIMULATION_RATE);
+  // rand() is never seeded, which is the same as the default seed 1
+  recording.level       = Breakout.level;
+  recording.endless     = Breakout.endless_seed;
+  recording.autopilot   = Breakout.autopilot;
+  recording.fixed_point = Breakout.fixed_point;
+  recording.rate        = SIMULATION_RATE;
+  recording_start       = glfwGetTime();
+  simulation.start();
 
+  FileWatcher watcher;
+  if (hot_reload
+      && watcher.watch("../resources/levels", Breakout.level_changes)
+      && watcher.watch("../resources/shaders", Breakout.shader_changes))
+    watcher.start(glfwPostEmptyEvent);
+
+  FramePacer pacer(frame_rate);
+  GpuTimer gpu_timer;
+  ResolutionController resolution(frame_budget / 1000.0, MIN_DYNAMIC_SCALE, Breakout.render_scale);
+  RunningStats gpu_time, render_scale;
+  LatencyProbe latency;
+  latency_histogram = &latency.histogram();
+  if (latency_overlay)
+    Breakout.latency_overlay = latency_histogram;
+  std::unique_ptr<FrameCapture> capture;
+  if (capture_directory)
+    capture = std::make_unique<FrameCapture>(framebuffer_width, framebuffer_height, capture_directory);
+  bool idle = false;
   while (!glfwWindowShouldClose(window)) {
+    // a still scene only needs waking up for input, or for the simulation
+    // to change something, which the timeout polls for
+    if (idle) {
+      glfwWaitEventsTimeout(IDLE_POLL);
+    } else {
+      pacer.wait();
+      glfwPollEvents();
+    }
+
     // calculate delta time
     // --------------------
-    float currentFrame = glfwGetTime();
+    double currentFrame = glfwGetTime();
     deltaTime = currentFrame - lastFrame;
     lastFrame = currentFrame;
-    glfwPollEvents();
 
-    // manage user input
-    // -----------------
-    Breakout.process_input(deltaTime);
+    // rebuild saved shaders between frames
+    if (Breakout.apply_shader_changes())
+      force_redraw = true;
 
-    // update game state
-    // -----------------
-    Breakout.update(deltaTime);
+    // pick up the latest world and how far we are into the next tick
+    // ---------------------------------------------------------------
+    WorldSnapshot& world = simulation.acquire();
+    float alpha = std::clamp(
+      static_cast<float>((currentFrame - world.time) / simulation.period()),
+      0.0f, 1.0f);
 
-    // render
-    // ------
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-    Breakout.render();
+    // render, unless it would draw the same frame again
+    // --------------------------------------------------
+    bool present = force_redraw || Breakout.needs_redraw(world);
+    if (present) {
+      AllocationScope scope("render");
+      gpu_timer.begin();
+      glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+      glClear(GL_COLOR_BUFFER_BIT);
+      Breakout.render(world, alpha, deltaTime);
+      gpu_timer.end();
+      if (capture)
+        capture->capture();
+      glfwSwapBuffers(window);
+      double swapped = glfwGetTime();
+      Breakout.presented(world, swapped);
+      latency.presented(Breakout.frame_latency, swapped);
+      render_scale.add(Breakout.render_scale);
+    }
 
-    glfwSwapBuffers(window);
+    // GPU times arrive a few frames late; the controller reacts to them
+    // by changing the scene resolution for the frames to come
+    double frame_gpu_time = gpu_timer.poll();
+    if (frame_gpu_time >= 0.0) {
+      gpu_time.add(frame_gpu_time);
+      if (frame_budget > 0.0)
+        Breakout.set_render_scale(resolution.update(frame_gpu_time));
+    }
+    force_redraw = false;
+
+    pacer.end_frame(present, idle);
+    idle = !present && currentFrame - last_input > INPUT_GRACE;
+  }
+
+  watcher.stop();
+  simulation.stop();
+  if (capture) {
+    capture->finish();
+    std::cout << "capture: " << capture->frames() << " frames to " << capture_directory << ", "
+              << capture->failures() << " failed, mean "
+              << capture->capture_time().mean() * 1000.0 << " ms per frame, "
+              << capture->stall_time() * 1000.0 << " ms stalled" << std::endl;
+    capture.reset();
+  }
+
+  if (record_file) {
+    recording.ticks = (glfwGetTime() - recording_start) * SIMULATION_RATE;
+    if (save_session(record_file, recording))
+      std::cout << "session saved to " << record_file << std::endl;
+  }
+
+  if (Breakout.pilot.query_time().count() > 0)
+    std::cout << "autopilot: " << Breakout.pilot.query_time().count() << " predictions, "
+              << "mean " << Breakout.pilot.query_time().mean() * 1e6 << " us, "
+              << "max "  << Breakout.pilot.query_time().max()  * 1e6 << " us" << std::endl;
+  std::cout << "tick jitter: mean " << simulation.jitter().mean() * 1000.0 << " ms, "
+            << "stddev " << simulation.jitter().stddev() * 1000.0 << " ms, "
+            << "max "    << simulation.jitter().max()    * 1000.0 << " ms, "
+            << simulation.skipped_ticks() << " ticks skipped" << std::endl;
+  std::cout << "input latency: " << Breakout.input_latency.count() << " events, "
+            << "mean " << Breakout.input_latency.mean() * 1000.0 << " ms, "
+            << "max "  << Breakout.input_latency.max()  * 1000.0 << " ms, "
+            << Breakout.input_queue.dropped() << " dropped" << std::endl;
+  const LatencyHistogram& latencies = latency.histogram();
+  std::cout << "input to GPU: " << latencies.count() << " frames, "
+            << "p50 " << latencies.percentile(0.5) * 1000.0 << " ms, "
+            << "p99 " << latencies.percentile(0.99) * 1000.0 << " ms (last "
+            << LatencyHistogram::window << "), " << latency.dropped() << " dropped" << std::endl;
+  for (unsigned int stage = STAGE_INPUT; stage < LATENCY_STAGES; ++stage)
+    std::cout << "  to " << latency_stage_name(LatencyStage(stage)) << ": mean "
+              << latency.stage(LatencyStage(stage)).mean() * 1000.0 << " ms, "
+              << "max " << latency.stage(LatencyStage(stage)).max() * 1000.0 << " ms" << std::endl;
+  if (latency_file && latencies.save_csv(latency_file))
+    std::cout << "latency histogram saved to " << latency_file << std::endl;
+  for (unsigned int type = 0; type < GAME_EVENT_TYPES; ++type) {
+    const RunningStats& counts = Breakout.events.per_tick(GameEventType(type));
+    std::cout << event_name(GameEventType(type)) << ": mean " << counts.mean()
+              << " per tick, max " << counts.max() << std::endl;
   }
+  std::cout << "frames: " << pacer.presented_frames() << " presented, "
+            << pacer.skipped_frames() << " skipped, cap " << pacer.rate() << " fps" << std::endl;
+  std::cout << "frame time: mean " << pacer.frame_times().mean() * 1000.0 << " ms, "
+            << "stddev " << pacer.frame_times().stddev() * 1000.0 << " ms, "
+            << "max "    << pacer.frame_times().max()    * 1000.0 << " ms" << std::endl;
+  std::cout << "render thread CPU: idle " << pacer.idle_cpu() * 100.0 << "%, "
+            << "active " << pacer.active_cpu() * 100.0 << "%" << std::endl;
+  std::cout << "GPU time: mean " << gpu_time.mean() * 1000.0 << " ms, "
+            << "max " << gpu_time.max() * 1000.0 << " ms per frame" << std::endl;
+  std::cout << "render scale: mean " << render_scale.mean() << ", "
+            << "min " << render_scale.min() << ", final " << Breakout.render_scale
+            << ", " << Breakout.msaa_samples << "x MSAA" << std::endl;
+  for (unsigned int call = 0; call < DRIVER_CALLS; ++call)
+    std::cout << "GL " << driver_call_name(DriverCall(call)) << ": mean "
+              << Breakout.gl_calls[call].mean() << " per frame, "
+              << "max " << Breakout.gl_calls[call].max() << std::endl;
+  if (hot_reload)
+    std::cout << "hot reloads: " << Breakout.reload_latency.count() << ", "
+              << "mean " << Breakout.reload_latency.mean() * 1000.0 << " ms, "
+              << "max "  << Breakout.reload_latency.max()  * 1000.0 << " ms from save to screen, "
+              << "compiles stalled frames by mean " << Breakout.reload_stall.mean() * 1000.0
+              << " ms, max " << Breakout.reload_stall.max() * 1000.0 << " ms" << std::endl;
+  std::cout << "texture binds: mean "<< Breakout.texture_binds.mean() << " per frame, "
+            << "max " << Breakout.texture_binds.max() << std::endl;
+
+  report_allocations(std::cout);
 
   // delete all resources as loaded using the resource manager
   // ---------------------------------------------------------
@@ -106,14 +350,19 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
   // when a user presses the escape key, we set the WindowShouldClose property to true, closing the application
   if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
     glfwSetWindowShouldClose(window, true);
-  if (key >= 0 && key < 1024) {
-    if (action == GLFW_PRESS)
-      Breakout.keys[key] = true;
-    else if (action == GLFW_RELEASE) {
-      Breakout.keys[key] = false;
-      Breakout.key_processed[key] = false;
-    }
-
+  // the overlay belongs to the render thread, which is this one
+  if (key == GLFW_KEY_F3 && action == GLFW_PRESS) {
+    Breakout.latency_overlay = Breakout.latency_overlay ? nullptr : latency_histogram;
+    force_redraw = true;
+  }
+  // key state is owned by the simulation: queue the transition with its
+  // timestamp and let process_input apply it at the right sub-frame time
+  if (key >= 0 && key < 1024 && (action == GLFW_PRESS || action == GLFW_RELEASE)) {
+    double time = glfwGetTime();
+    last_input = time;
+    Breakout.input_queue.push({key, action, time});
+    if (record_file)
+      recording.events.push_back({key, action, time - recording_start});
   }
 }
 
@@ -121,4 +370,11 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
   // make sure the viewport matches the new window dimensions; note that width and 
   // height will be significantly larger than specified on retina displays.
   glViewport(0, 0, width, height);
+  Breakout.resize_output(width, height);
+  force_redraw = true;
+}
+
+void window_refresh_callback(GLFWwindow*) {
+  // the window was uncovered or resized: redraw even if the scene is still
+  force_redraw = true;
 }
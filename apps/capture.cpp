@@ -0,0 +1,283 @@
+/*******************************************************************
+ ** This code is part of Breakout.
+ **
+ ** Breakout is free software: you can redistribute it and/or modify
+ ** it under the terms of the CC BY 4.0 license as published by
+ ** Creative Commons, either version 4 of the License, or (at your
+ ** option) any later version.
+ ******************************************************************/
+
+// Replays a recorded session through the OpenGL renderer without a
+// display, and saves the frames as an image sequence: for recordings, and
+// for golden-image tests of the renderer.
+// Usage: capture [--session FILE] [--out DIR] [--every TICKS] [--frames N]
+//                [--window WxH] [--msaa N] [--osmesa] [--software]
+//                [--no-capture] [--golden DIR] [--tolerance N] [--root DIR]
+// A frame is rendered every TICKS simulation ticks, 2 by default, which is
+// 60 frames per second of a 120 Hz session. With --golden, the frames are
+// compared against those of an earlier run, and it exits with 1 when a
+// channel of any pixel differs by more than the tolerance. Like the other
+// tools, it runs from a directory next to resources/, e.g. build/; --root
+// names the project directory when the default, the parent of the
+// working directory, is not it.
+// GLFW 3.4 and up create the context on its null platform, through EGL
+// (surfaceless) or OSMesa; older versions need a display for a hidden
+// window. --software renders with SoftwareRenderer instead, with no GL at
+// all, at the game's own 800x600.
+
+#include <pangolin/glfw-support.hpp>
+#include <pangolin/resource-manager.hpp>
+
+#include <breakout/game.hpp>
+#include <breakout/session.hpp>
+#include <breakout/frame-capture.hpp>
+#include <breakout/software-renderer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+const unsigned int SCREEN_WIDTH  = 800;
+const unsigned int SCREEN_HEIGHT = 600;
+// Largest difference of a channel still counted as a match with --golden
+const int DEFAULT_TOLERANCE = 8;
+
+using Clock = std::chrono::steady_clock;
+
+// compares the first `frames` frames of two captures; true when all match
+static auto compare_frames(const std::string& directory, const std::string& golden,
+                           unsigned int frames, int tolerance) -> bool {
+  unsigned int mismatched = 0;
+  SoftImage frame, expected;
+  for (unsigned int i = 0; i < frames; ++i) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/frame-%06u.ppm", i);
+    if (!load_soft_image((golden + name).c_str(), expected)
+        || !load_soft_image((directory + name).c_str(), frame)) {
+      ++mismatched;
+      continue;
+    }
+    if (frame.width != expected.width || frame.height != expected.height) {
+      std::printf("%s: %dx%d, expected %dx%d\n", name + 1,
+                  frame.width, frame.height, expected.width, expected.height);
+      ++mismatched;
+      continue;
+    }
+    std::size_t differing = 0;
+    int largest = 0;
+    for (std::size_t p = 0; p < frame.pixels.size(); ++p) {
+      int difference = 0;
+      for (int shift = 0; shift < 24; shift += 8)
+        difference = std::max(difference, std::abs(int((frame.pixels[p] >> shift) & 0xFF)
+                                                    - int((expected.pixels[p] >> shift) & 0xFF)));
+      differing += difference > tolerance;
+      largest = std::max(largest, difference);
+    }
+    if (differing > 0) {
+      std::printf("%s: %zu pixels differ, by up to %d\n", name + 1, differing, largest);
+      ++mismatched;
+    }
+  }
+  std::printf("golden: %u of %u frames match %s\n", frames - mismatched, frames, golden.c_str());
+  return mismatched == 0;
+}
+
+// --software: the session's frames from SoftwareRenderer, saved in
+// `directory` unless it is empty; returns the frames that failed to save
+static auto capture_software(const Session& session, const std::string& directory,
+                             unsigned int every, unsigned int frames,
+                             unsigned int& rendered) -> unsigned int {
+  Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+  game.muted = true;
+  game.init_world();
+  // no GL renderer: the software one takes the broken bricks' bursts
+  game.burst_events = true;
+  SessionReplay replay(game, session);
+  SoftwareRenderer renderer(SCREEN_WIDTH, SCREEN_HEIGHT, std::thread::hardware_concurrency());
+  if (!renderer.load_textures("../resources/textures")
+      || !renderer.load_font("../resources/fonts/ocraext.TTF", 24))
+    return 1;
+  if (!directory.empty())
+    std::filesystem::create_directories(directory);
+
+  WorldSnapshot world;
+  SoftImage frame;
+  float frame_time = static_cast<float>(every / session.rate);
+  unsigned int failed = 0;
+  rendered = 0;
+  while ((frames == 0 || rendered < frames) && replay.tick()) {
+    if (replay.ticks() % every != 0)
+      continue;
+    game.snapshot(world, replay.ticks() / session.rate);
+    renderer.update_particles(game.render_events, world, 1.0f, frame_time);
+    renderer.render(world, 1.0f, static_cast<float>(world.time), frame);
+    if (!directory.empty()) {
+      char name[32];
+      std::snprintf(name, sizeof(name), "/frame-%06u.ppm", rendered);
+      failed += !write_ppm((directory + name).c_str(), frame);
+    }
+    ++rendered;
+  }
+  return failed;
+}
+
+int main(int argc, char *argv[]) {
+  const char* session_file = "../resources/sessions/level-one.ses";
+  std::string directory = "capture";
+  std::string root = std::filesystem::current_path().parent_path().string();
+  std::string golden;
+  unsigned int every = 2, frames = 0;
+  unsigned int width = SCREEN_WIDTH, height = SCREEN_HEIGHT;
+  unsigned int samples = 4;
+  int tolerance = DEFAULT_TOLERANCE;
+  bool osmesa = false, software = false, save = true;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--session") == 0 && i + 1 < argc)
+      session_file = argv[++i];
+    else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+      directory = argv[++i];
+    else if (std::strcmp(argv[i], "--every") == 0 && i + 1 < argc)
+      every = std::max(1, std::atoi(argv[++i]));
+    else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+      frames = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--window") == 0 && i + 1 < argc)
+      std::sscanf(argv[++i], "%ux%u", &width, &height);
+    else if (std::strcmp(argv[i], "--msaa") == 0 && i + 1 < argc)
+      samples = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--osmesa") == 0)
+      osmesa = true;
+    else if (std::strcmp(argv[i], "--software") == 0)
+      software = true;
+    else if (std::strcmp(argv[i], "--no-capture") == 0)
+      save = false;
+    else if (std::strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+      golden = argv[++i];
+    else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+      tolerance = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--root") == 0 && i + 1 < argc)
+      root = argv[++i];
+  }
+
+  Session session;
+  if (!load_session(session_file, session)) {
+    std::printf("failed to load %s\n", session_file);
+    return EXIT_FAILURE;
+  }
+
+  if (software) {
+    unsigned int rendered = 0;
+    auto begin = Clock::now();
+    unsigned int failed = capture_software(session, save ? directory : std::string(),
+                                           every, frames, rendered);
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    std::printf("%s: %u frames in software at %ux%u, %.1f fps, %u failed\n", session_file,
+                rendered, SCREEN_WIDTH, SCREEN_HEIGHT, rendered / seconds, failed);
+    bool passed = failed == 0;
+    if (save && !golden.empty())
+      passed = compare_frames(directory, golden, rendered, tolerance) && passed;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  // a context without a display: no window system, and the window itself
+  // is never shown, so everything is drawn into an offscreen framebuffer
+  // --------------------------------------------------------------------
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+  glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+  if (!glfwInit()) {
+    std::printf("failed to initialize GLFW\n");
+    return EXIT_FAILURE;
+  }
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_CONTEXT_CREATION_API, osmesa ? GLFW_OSMESA_CONTEXT_API : GLFW_EGL_CONTEXT_API);
+  glfwWindowHint(GLFW_VISIBLE, false);
+  GLFWwindow* window = glfwCreateWindow(width, height, "Breakout capture", nullptr, nullptr);
+  if (!window) {
+    std::printf("failed to create a headless %s context\n", osmesa ? "OSMesa" : "EGL");
+    glfwTerminate();
+    return EXIT_FAILURE;
+  }
+  glfwMakeContextCurrent(window);
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+    std::printf("failed to initialize GLAD\n");
+    return EXIT_FAILURE;
+  }
+
+  unsigned int framebuffer, color;
+  glGenFramebuffers(1, &framebuffer);
+  glGenRenderbuffers(1, &color);
+  glBindRenderbuffer(GL_RENDERBUFFER, color);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    std::printf("failed to create the output framebuffer\n");
+    return EXIT_FAILURE;
+  }
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+  pgl::set_root(root.c_str());
+  Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+  game.muted = true;
+  game.msaa_samples = samples;
+  game.resize_output(width, height, framebuffer);
+  game.init();
+  SessionReplay replay(game, session);
+
+  std::unique_ptr<FrameCapture> capture;
+  if (save)
+    capture = std::make_unique<FrameCapture>(width, height, directory);
+
+  WorldSnapshot world;
+  float frame_time = static_cast<float>(every / session.rate);
+  unsigned int rendered = 0;
+  auto begin = Clock::now();
+  while ((frames == 0 || rendered < frames) && replay.tick()) {
+    if (replay.ticks() % every != 0)
+      continue;
+    game.snapshot(world, replay.ticks() / session.rate);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    game.render(world, 1.0f, frame_time);
+    if (capture)
+      capture->capture();
+    ++rendered;
+  }
+  if (capture)
+    capture->finish();
+  glFinish();
+  double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+  std::printf("%s: %u frames at %ux%u, %.1f fps\n",
+              session_file, rendered, width, height, rendered / seconds);
+  bool passed = true;
+  if (capture) {
+    double frame_cost = seconds / std::max(rendered, 1u);
+    std::printf("capture: %u frames to %s, %u failed, mean %.3f ms per frame (%.1f%%), %.1f ms stalled\n",
+                capture->frames(), directory.c_str(), capture->failures(),
+                capture->capture_time().mean() * 1e3,
+                capture->capture_time().mean() / frame_cost * 100.0,
+                capture->stall_time() * 1e3);
+    passed = capture->failures() == 0;
+    capture.reset();
+    if (!golden.empty())
+      passed = compare_frames(directory, golden, rendered, tolerance) && passed;
+  }
+
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteRenderbuffers(1, &color);
+  pgl::ResourceManager::clear();
+  glfwTerminate();
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,143 @@
+/*******************************************************************
+ ** This code is part of Breakout.
+ **
+ ** Breakout is free software: you can redistribute it and/or modify
+ ** it under the terms of the CC BY 4.0 license as published by
+ ** Creative Commons, either version 4 of the License, or (at your
+ ** option) any later version.
+ ******************************************************************/
+
+// Measures level parsing throughput: parse_level over the mapped file
+// against the original loader, std::getline and an std::istringstream
+// per line into nested vectors. Runs over the game's levels and over a
+// generated level of N by N random tiles, then times GameLevel::load on
+// the generated level as a whole, bricks and merged colliders included.
+// Usage: level-bench [--levels DIR] [--tiles N] [--repeat N]
+
+#include <breakout/game-level.hpp>
+#include <breakout/mapped-file.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+const int DEFAULT_REPEAT = 5;
+// Side of the generated level, in tiles
+const unsigned int DEFAULT_TILES = 2048;
+
+using Clock = std::chrono::steady_clock;
+
+// the loader parse_level replaced, kept as the baseline
+static auto legacy_parse(const char* file, std::vector<std::vector<unsigned int>>& tile_data) -> bool {
+  unsigned int tileCode;
+  std::string line;
+  std::ifstream fstream(file);
+  tile_data.clear();
+  if (!fstream)
+    return false;
+  while (std::getline(fstream, line)) {
+    std::istringstream sstream(line);
+    std::vector<unsigned int> row;
+    while (sstream >> tileCode)
+      row.push_back(tileCode);
+    tile_data.push_back(row);
+  }
+  return true;
+}
+
+// best time of `repeat` runs of `job` (s)
+template<typename Job>
+static auto best_time(int repeat, Job job) -> double {
+  double best = 1e30;
+  for (int i = 0; i < repeat; ++i) {
+    auto start = Clock::now();
+    job();
+    best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+  }
+  return best;
+}
+
+static auto same_tiles(const std::vector<std::vector<unsigned int>>& tile_data,
+                       const LevelTiles& tiles) -> bool {
+  std::size_t i = 0;
+  for (const std::vector<unsigned int>& row : tile_data) {
+    if (row.empty())
+      continue;
+    if (row.size() != tiles.width)
+      return false;
+    for (unsigned int code : row)
+      if (std::min(code, 255u) != tiles.codes[i++])
+        return false;
+  }
+  return i == tiles.codes.size();
+}
+
+static void compare(const std::string& file, int repeat) {
+  std::vector<std::vector<unsigned int>> tile_data;
+  LevelTiles tiles;
+  double legacy = best_time(repeat, [&] { legacy_parse(file.c_str(), tile_data); });
+  double parsed = best_time(repeat, [&] {
+    MappedFile text(file.c_str());
+    parse_level(text.data(), text.data() + text.size(), file.c_str(), tiles);
+  });
+  double megabytes = std::filesystem::file_size(file) / 1e6;
+  std::printf("%-24s %9.3f MB %4ux%-5u getline %8.1f MB/s  from_chars %8.1f MB/s  %5.1fx%s\n",
+              std::filesystem::path(file).filename().string().c_str(), megabytes,
+              tiles.width, tiles.height, megabytes / legacy, megabytes / parsed,
+              legacy / parsed, same_tiles(tile_data, tiles) ? "" : "  MISMATCH");
+}
+
+int main(int argc, char *argv[]) {
+  std::string directory = "../resources/levels";
+  unsigned int side = DEFAULT_TILES;
+  int repeat = DEFAULT_REPEAT;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--levels") == 0 && i + 1 < argc)
+      directory = argv[++i];
+    else if (std::strcmp(argv[i], "--tiles") == 0 && i + 1 < argc)
+      side = std::max(1, std::atoi(argv[++i]));
+    else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+      repeat = std::max(1, std::atoi(argv[++i]));
+  }
+
+  std::vector<std::filesystem::path> files;
+  for (const auto& entry : std::filesystem::directory_iterator(directory))
+    if (entry.path().extension() == ".lvl")
+      files.push_back(entry.path());
+  std::sort(files.begin(), files.end());
+  for (const std::filesystem::path& file : files)
+    compare(file.string(), repeat * 100);
+
+  // mostly colored bricks, with solid ones to merge and gaps
+  std::string generated = (std::filesystem::temp_directory_path() / "level-bench.lvl").string();
+  {
+    std::minstd_rand random(1);
+    std::ofstream fstream(generated);
+    std::string row;
+    for (unsigned int y = 0; y < side; ++y) {
+      row.clear();
+      for (unsigned int x = 0; x < side; ++x) {
+        row += char('0' + random() % 6);
+        row += x + 1 < side ? ' ' : '\n';
+      }
+      fstream << row;
+    }
+  }
+  compare(generated, repeat);
+
+  GameLevel level;
+  double load = best_time(repeat, [&] { level.load(generated.c_str(), 800, 300); });
+  std::printf("GameLevel::load %ux%u: %.1f ms, %zu bricks, %zu colliders for %u solid\n",
+              side, side, load * 1e3, level.bricks.size(), level.colliders.size(),
+              level.solid_count);
+  std::filesystem::remove(generated);
+  return EXIT_SUCCESS;
+}
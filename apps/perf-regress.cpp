@@ -0,0 +1,256 @@
+/*******************************************************************
+ ** This code is part of Breakout.
+ **
+ ** Breakout is free software: you can redistribute it and/or modify
+ ** it under the terms of the CC BY 4.0 license as published by
+ ** Creative Commons, either version 4 of the License, or (at your
+ ** option) any later version.
+ ******************************************************************/
+
+// Replays the recorded sessions of resources/sessions headlessly through
+// Game::process_input and Game::update, and compares the cost per tick
+// and the peak resident set size against a stored baseline.
+// Usage: perf-regress [--sessions DIR] [--baseline FILE] [--repeat N]
+//                     [--tolerance FRACTION] [--update]
+// Each session is replayed N times and the best of each number is kept,
+// which filters out most scheduling noise. Exits with 1 when a number
+// regressed by more than the tolerance, or when there is no baseline to
+// compare with. Timings are absolute, so a baseline names the machine
+// (CPU model and thread count) it was recorded on; against one from
+// another machine the comparison is printed but never fails, and the
+// baseline has to be recorded again with --update where the gate runs.
+// Replays are muted, so that sound doesn't count either.
+
+#include <breakout/game.hpp>
+#include <breakout/session.hpp>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+const unsigned int SCREEN_WIDTH  = 800;
+const unsigned int SCREEN_HEIGHT = 600;
+// Allowed slowdown before a number counts as a regression
+const double DEFAULT_TOLERANCE = 0.25;
+// Replays of each session
+const int DEFAULT_REPEAT = 5;
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+  double median_ns = 0.0;
+  double p99_ns    = 0.0;
+  double ticks_per_second = 0.0;
+};
+
+static auto peak_rss_kb() -> long {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+// `samples` is reordered
+static auto percentile(std::vector<double>& samples, double fraction) -> double {
+  auto nth = samples.begin() + static_cast<std::size_t>(fraction * (samples.size() - 1));
+  std::nth_element(samples.begin(), nth, samples.end());
+  return *nth;
+}
+
+static auto replay(const Session& session, std::vector<double>& samples) -> Result {
+  Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+  game.muted = true;
+  game.init_world();
+  SessionReplay replay(game, session);
+
+  samples.clear();
+  samples.reserve(session.ticks);
+  auto begin = Clock::now();
+  for (;;) {
+    auto start = Clock::now();
+    if (!replay.tick())
+      break;
+    samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+  }
+  double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+  Result result;
+  if (samples.empty())
+    return result;
+  result.ticks_per_second = samples.size() / seconds;
+  result.median_ns = percentile(samples, 0.5);
+  result.p99_ns    = percentile(samples, 0.99);
+  return result;
+}
+
+// CPU model and hardware threads, e.g. "AMD Ryzen 7 5800X x16"
+static auto machine_name() -> std::string {
+  std::string model = "unknown CPU";
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    std::size_t colon = line.find(':');
+    if (line.rfind("model name", 0) == 0 && colon != std::string::npos) {
+      model = line.substr(std::min(colon + 2, line.size()));
+      break;
+    }
+  }
+  return model + " x" + std::to_string(std::thread::hardware_concurrency());
+}
+
+// lines of "name median_ns p99_ns ticks_per_second", "peak_rss_kb N" and
+// "machine NAME"
+static auto load_baseline(const std::string& file, std::map<std::string, Result>& results,
+                          long& rss_kb, std::string& machine) -> bool {
+  std::ifstream fstream(file);
+  if (!fstream)
+    return false;
+  std::string line, name;
+  while (std::getline(fstream, line)) {
+    std::istringstream sstream(line);
+    if (!(sstream >> name) || name[0] == '#')
+      continue;
+    if (name == "peak_rss_kb") {
+      sstream >> rss_kb;
+      continue;
+    }
+    if (name == "machine") {
+      std::getline(sstream >> std::ws, machine);
+      continue;
+    }
+    Result& result = results[name];
+    sstream >> result.median_ns >> result.p99_ns >> result.ticks_per_second;
+  }
+  return true;
+}
+
+static auto save_baseline(const std::string& file, const std::map<std::string, Result>& results,
+                          long rss_kb, const std::string& machine) -> bool {
+  std::ofstream fstream(file);
+  fstream << "# session median_ns p99_ns ticks_per_second\n";
+  fstream << "machine " << machine << "\n";
+  for (const auto& [name, result] : results)
+    fstream << name << " " << result.median_ns << " " << result.p99_ns << " "
+            << result.ticks_per_second << "\n";
+  fstream << "peak_rss_kb " << rss_kb << "\n";
+  return bool(fstream);
+}
+
+// prints the comparison; true when `value` is within tolerance
+static auto check(const char* what, double value, double baseline, bool higher_is_worse,
+                  double tolerance) -> bool {
+  double change = baseline > 0.0 ? value / baseline - 1.0 : 0.0;
+  bool regressed = higher_is_worse ? change > tolerance
+                                   : -change / (1.0 + change) > tolerance;
+  std::printf("    %-18s %12.1f  baseline %12.1f  %+6.1f%%%s\n",
+              what, value, baseline, change * 100.0, regressed ? "  REGRESSION" : "");
+  return !regressed;
+}
+
+int main(int argc, char *argv[]) {
+  std::string directory = "../resources/sessions";
+  std::string baseline_file;
+  double tolerance = DEFAULT_TOLERANCE;
+  int repeat = DEFAULT_REPEAT;
+  bool update = false;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--sessions") == 0 && i + 1 < argc)
+      directory = argv[++i];
+    else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+      baseline_file = argv[++i];
+    else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+      repeat = std::max(1, std::atoi(argv[++i]));
+    else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+      tolerance = std::atof(argv[++i]);
+    else if (std::strcmp(argv[i], "--update") == 0)
+      update = true;
+  }
+  if (baseline_file.empty())
+    baseline_file = directory + "/baseline.txt";
+
+  std::vector<std::filesystem::path> files;
+  for (const auto& entry : std::filesystem::directory_iterator(directory))
+    if (entry.path().extension() == ".ses")
+      files.push_back(entry.path());
+  std::sort(files.begin(), files.end());
+  if (files.empty()) {
+    std::printf("no sessions in %s\n", directory.c_str());
+    return EXIT_FAILURE;
+  }
+
+  std::map<std::string, Result> results;
+  std::vector<double> samples;
+  for (const auto& file : files) {
+    Session session;
+    if (!load_session(file.c_str(), session))
+      return EXIT_FAILURE;
+    Result result = replay(session, samples);
+    for (int i = 1; i < repeat; ++i) {
+      Result next = replay(session, samples);
+      result.median_ns = std::min(result.median_ns, next.median_ns);
+      result.p99_ns    = std::min(result.p99_ns, next.p99_ns);
+      result.ticks_per_second = std::max(result.ticks_per_second, next.ticks_per_second);
+    }
+    results[file.stem().string()] = result;
+    std::printf("%-14s %7zu ticks  median %8.1f ns  p99 %8.1f ns  %10.0f ticks/s\n",
+                file.stem().c_str(), samples.size(), result.median_ns, result.p99_ns,
+                result.ticks_per_second);
+  }
+  long rss_kb = peak_rss_kb();
+  std::printf("peak RSS %ld kB\n", rss_kb);
+
+  std::string machine = machine_name();
+  if (update) {
+    if (!save_baseline(baseline_file, results, rss_kb, machine)) {
+      std::printf("could not write %s\n", baseline_file.c_str());
+      return EXIT_FAILURE;
+    }
+    std::printf("baseline written to %s\n", baseline_file.c_str());
+    return EXIT_SUCCESS;
+  }
+
+  std::map<std::string, Result> baseline;
+  long baseline_rss_kb = 0;
+  std::string baseline_machine = "an unnamed machine";
+  if (!load_baseline(baseline_file, baseline, baseline_rss_kb, baseline_machine)) {
+    // a gate without a baseline would pass anything
+    std::printf("no baseline at %s, run with --update to record one\n", baseline_file.c_str());
+    return EXIT_FAILURE;
+  }
+
+  std::printf("compared to %s, tolerance %.0f%%\n", baseline_file.c_str(), tolerance * 100.0);
+  bool ok = true;
+  for (const auto& [name, result] : results) {
+    auto it = baseline.find(name);
+    if (it == baseline.end()) {
+      std::printf("  %s: not in baseline\n", name.c_str());
+      continue;
+    }
+    std::printf("  %s\n", name.c_str());
+    ok &= check("median ns/tick", result.median_ns, it->second.median_ns, true, tolerance);
+    ok &= check("p99 ns/tick", result.p99_ns, it->second.p99_ns, true, tolerance);
+    ok &= check("ticks/s", result.ticks_per_second, it->second.ticks_per_second, false, tolerance);
+  }
+  if (baseline_rss_kb > 0)
+    ok &= check("peak RSS kB", rss_kb, baseline_rss_kb, true, tolerance);
+
+  std::printf(ok ? "no regression\n" : "performance regressed\n");
+  if (baseline_machine != machine) {
+    // absolute timings from other hardware say nothing about this change
+    std::printf("the baseline was recorded on %s, this is %s: not gating.\n"
+                "record it on this machine with --update to enable the gate\n",
+                baseline_machine.c_str(), machine.c_str());
+    return EXIT_SUCCESS;
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,146 @@
+/*******************************************************************
+ ** This code is part of Breakout.
+ **
+ ** Breakout is free software: you can redistribute it and/or modify
+ ** it under the terms of the CC BY 4.0 license as published by
+ ** Creative Commons, either version 4 of the License, or (at your
+ ** option) any later version.
+ ******************************************************************/
+
+// Compares the float and fixed-point physics: circle/box test throughput
+// and whole-tick throughput over the recorded sessions. Also prints the
+// final state hash of every replay. In fixed-point mode the hashes must
+// not change between builds (compiler, -O level, -ffast-math, -march).
+// Lists how many colliders each level has before and after solid bricks
+// are merged.
+// Usage: physics-bench [--sessions DIR] [--repeat N]
+
+#include <breakout/game.hpp>
+#include <breakout/fixed-physics.hpp>
+#include <breakout/session.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+const unsigned int SCREEN_WIDTH  = 800;
+const unsigned int SCREEN_HEIGHT = 600;
+// Ball positions swept over the level by the collision benchmark
+const int SWEEP_STEPS = 200;
+
+using Clock = std::chrono::steady_clock;
+
+// ns per circle/box test, ball swept over a grid covering the level
+template<typename Check>
+static auto collision_ns(std::vector<pgl::GameObject>& bricks, Check check,
+                         unsigned int& hits) -> double {
+  BallObject ball;
+  ball.size = pgl::float2(ball.radius * 2.0f);
+  hits = 0;
+  auto start = Clock::now();
+  for (int y = 0; y < SWEEP_STEPS; ++y) {
+    for (int x = 0; x < SWEEP_STEPS; ++x) {
+      ball.position = pgl::float2(x * (SCREEN_WIDTH / float(SWEEP_STEPS)),
+                                  y * (SCREEN_HEIGHT / 2.0f / SWEEP_STEPS));
+      hits += check(ball);
+    }
+  }
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  return seconds * 1e9 / (double(SWEEP_STEPS) * SWEEP_STEPS * bricks.size());
+}
+
+// best ticks per second over `repeat` replays, and the final state hash
+static auto replay(Session session, bool fixed_point, int repeat,
+                   std::uint64_t& hash) -> double {
+  session.fixed_point = fixed_point;
+  double best = 0.0;
+  for (int i = 0; i < repeat; ++i) {
+    Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+    game.muted = true;
+    game.init_world();
+    SessionReplay replay(game, session);
+    auto start = Clock::now();
+    while (replay.tick())
+      ;
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    best = std::max(best, replay.ticks() / seconds);
+    hash = game.state_hash();
+  }
+  return best;
+}
+
+int main(int argc, char *argv[]) {
+  std::string directory = "../resources/sessions";
+  int repeat = 5;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--sessions") == 0 && i + 1 < argc)
+      directory = argv[++i];
+    else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+      repeat = std::max(1, std::atoi(argv[++i]));
+  }
+
+  Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+  game.muted = true;
+  game.init_world();
+  for (std::size_t i = 0; i < game.levels.size(); ++i) {
+    const GameLevel& level = game.levels[i];
+    std::size_t breakable = level.bricks.size() - level.solid_count;
+    std::printf("level %zu colliders  %3zu -> %3zu  (%u solid bricks merged into %zu)\n",
+                i + 1, level.bricks.size(), breakable + level.colliders.size(),
+                level.solid_count, level.colliders.size());
+  }
+
+  std::vector<pgl::GameObject> bricks = game.bricks();
+  // the fixed path tests against boxes cached once per level, like
+  // Game::process_collisions does
+  std::vector<FixedBox> boxes;
+  for (const pgl::GameObject& brick : bricks)
+    boxes.push_back(fixed_box(brick));
+  auto float_check = [&bricks](BallObject& ball) {
+    unsigned int hits = 0;
+    for (pgl::GameObject& brick : bricks)
+      hits += std::get<0>(CheckCollision(ball, brick));
+    return hits;
+  };
+  auto fixed_check = [&boxes](BallObject& ball) {
+    unsigned int hits = 0;
+    FixedCircle circle = fixed_circle(ball);
+    for (const FixedBox& box : boxes)
+      hits += std::get<0>(fixed_check_collision(circle, box));
+    return hits;
+  };
+
+  unsigned int float_hits, fixed_hits;
+  double float_ns = 1e9, fixed_ns = 1e9;
+  for (int i = 0; i < repeat; ++i) {
+    float_ns = std::min(float_ns, collision_ns(bricks, float_check, float_hits));
+    fixed_ns = std::min(fixed_ns, collision_ns(bricks, fixed_check, fixed_hits));
+  }
+  std::printf("circle/box test  float %6.2f ns  fixed %6.2f ns  (%u / %u hits)\n",
+              float_ns, fixed_ns, float_hits, fixed_hits);
+
+  std::vector<std::filesystem::path> files;
+  for (const auto& entry : std::filesystem::directory_iterator(directory))
+    if (entry.path().extension() == ".ses")
+      files.push_back(entry.path());
+  std::sort(files.begin(), files.end());
+
+  std::printf("%-14s %14s %14s  %-16s\n", "session", "float ticks/s", "fixed ticks/s", "fixed state hash");
+  for (const auto& file : files) {
+    Session session;
+    if (!load_session(file.c_str(), session))
+      return EXIT_FAILURE;
+    std::uint64_t float_hash, fixed_hash;
+    double float_rate = replay(session, false, repeat, float_hash);
+    double fixed_rate = replay(session, true, repeat, fixed_hash);
+    std::printf("%-14s %14.0f %14.0f  %016" PRIx64 "\n",
+                file.stem().c_str(), float_rate, fixed_rate, fixed_hash);
+  }
+  return EXIT_SUCCESS;
+}
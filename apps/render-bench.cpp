@@ -0,0 +1,113 @@
+/*******************************************************************
+ ** This code is part of Breakout.
+ **
+ ** Breakout is free software: you can redistribute it and/or modify
+ ** it under the terms of the CC BY 4.0 license as published by
+ ** Creative Commons, either version 4 of the License, or (at your
+ ** option) any later version.
+ ******************************************************************/
+
+// Renders a headless autopilot game with the CPU backend and reports
+// the throughput of the sprite pass and of each post-processing effect.
+// Usage: render-bench [--frames N] [--threads N] [--dump frame.ppm]
+
+#include <breakout/game.hpp>
+#include <breakout/software-renderer.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+const int FRAME_WIDTH  = 800;
+const int FRAME_HEIGHT = 600;
+const float TICK = 1.0f / 120.0f;
+
+using Clock = std::chrono::steady_clock;
+
+static void report(const char* pass, double seconds, int frames) {
+  double per_frame = seconds / frames;
+  double pixels    = double(FRAME_WIDTH) * FRAME_HEIGHT * frames / seconds;
+  std::printf("%-14s %8.3f ms/frame %8.1f fps %10.1f Mpixel/s\n",
+              pass, per_frame * 1e3, 1.0 / per_frame, pixels / 1e6);
+}
+
+int main(int argc, char *argv[]) {
+  int frames = 300;
+  unsigned int threads = std::thread::hardware_concurrency();
+  const char* dump = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+      frames = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+      threads = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--dump") == 0 && i + 1 < argc)
+      dump = argv[++i];
+  }
+
+  Game game(FRAME_WIDTH, FRAME_HEIGHT);
+  game.muted = true;
+  game.init_world();
+  game.autopilot = true;
+  game.state = GAME_ACTIVE;
+  game.burst_events = true;
+
+  SoftwareRenderer renderer(FRAME_WIDTH, FRAME_HEIGHT, threads);
+  if (!renderer.load_textures("../resources/textures")
+      || !renderer.load_font("../resources/fonts/ocraext.TTF", 24))
+    return EXIT_FAILURE;
+
+  WorldSnapshot world;
+  SoftImage frame;
+  double time = 0.0;
+  auto tick = [&] {
+    time += TICK;
+    game.process_input(TICK, time);
+    game.update(TICK);
+    game.snapshot(world, time);
+    renderer.update_particles(game.render_events, world, 0.5f, TICK);
+  };
+  for (int i = 0; i < 120; ++i)
+    tick();
+
+  std::printf("%dx%d, %u threads, %d frames\n", FRAME_WIDTH, FRAME_HEIGHT, threads, frames);
+
+  // sprite pass on a live game
+  double scene_time = 0.0;
+  for (int i = 0; i < frames; ++i) {
+    tick();
+    auto start = Clock::now();
+    renderer.draw_scene(world, 0.5f);
+    scene_time += std::chrono::duration<double>(Clock::now() - start).count();
+  }
+  report("sprites", scene_time, frames);
+
+  // each post-processing effect on the last scene
+  struct { const char* name; EffectState effects; } passes[] = {
+    { "post/none",    { false, false, false } },
+    { "post/confuse", { true,  false, false } },
+    { "post/chaos",   { false, true,  false } },
+    { "post/shake",   { false, false, true  } },
+  };
+  for (auto& pass : passes) {
+    auto start = Clock::now();
+    for (int i = 0; i < frames; ++i)
+      renderer.post_process(pass.effects, i * TICK, frame);
+    report(pass.name, std::chrono::duration<double>(Clock::now() - start).count(), frames);
+  }
+
+  // whole frames as the game would produce them
+  auto start = Clock::now();
+  for (int i = 0; i < frames; ++i) {
+    tick();
+    renderer.render(world, 0.5f, time, frame);
+  }
+  report("frame", std::chrono::duration<double>(Clock::now() - start).count(), frames);
+
+  if (dump && !write_ppm(dump, frame)) {
+    std::printf("could not write %s\n", dump);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+
+// Heap allocation accounting, compiled in with the CMake option
+// BREAKOUT_TRACK_ALLOCATIONS, and always in game-utils-tracked, the copy
+// of game-utils the allocation test links. When enabled, global operator new is
+// replaced and every allocation is charged to the phase innermost on the
+// allocating thread's AllocationScope stack ("other" outside any scope).
+// Without the option, scopes cost nothing and all counts read zero.
+
+struct AllocationCounts {
+  std::size_t count = 0;
+  std::size_t bytes = 0;
+};
+
+// Charges the allocations made on this thread during its lifetime to
+// `phase`. The name must outlive the program (use string literals).
+class AllocationScope {
+  public:
+#ifdef BREAKOUT_TRACK_ALLOCATIONS
+    explicit AllocationScope(const char* phase);
+    ~AllocationScope();
+#else
+    explicit AllocationScope(const char*) { }
+#endif
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+#ifdef BREAKOUT_TRACK_ALLOCATIONS
+  private:
+    int previous;
+#endif
+};
+
+// totals charged to `phase` so far
+auto allocation_counts(const char* phase) -> AllocationCounts;
+// one line per phase that allocated
+void report_allocations(std::ostream& out);
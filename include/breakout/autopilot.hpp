@@ -0,0 +1,75 @@
+#pragma once
+
+#include <breakout/ball-object.hpp>
+#include <breakout/fixed-point.hpp>
+#include <breakout/stats.hpp>
+
+#include <pangolin/game-object.hpp>
+#include <pgl-math/vector.hpp>
+
+#include <vector>
+
+// Where and when the ball will next reach the paddle line.
+struct Prediction {
+  bool         valid;   // false if the bounce budget ran out first
+  float        x;       // ball position.x at the crossing
+  float        time;    // seconds from now
+  unsigned int bounces; // walls and bricks hit on the way
+};
+
+// Traces the ball analytically, one straight segment per reflection,
+// against the side and top walls and the live bricks (treating the ball
+// as its bounding square, as CheckCollision effectively does when
+// resolving). The cost is proportional to bricks * bounces, not to the
+// flight time. `paddle_line` is the ball's position.y at which it touches
+// the paddle.
+auto predict_landing(
+  pgl::float2 position, pgl::float2 velocity, float radius, bool pass_through,
+  const std::vector<pgl::GameObject>& bricks,
+  float window_width, float paddle_line) -> Prediction;
+
+// predict_landing in Q16.16 integer math, for fixed-point games: the
+// paddle follows the prediction, so it must not depend on float flags.
+struct FixedPrediction {
+  bool         valid;
+  Fixed        x;
+  Fixed        time;
+  unsigned int bounces;
+};
+
+auto predict_landing_fixed(
+  Fixed2 position, Fixed2 velocity, Fixed radius, bool pass_through,
+  const std::vector<pgl::GameObject>& bricks,
+  Fixed window_width, Fixed paddle_line) -> FixedPrediction;
+
+// Autopilot stands in for a player: it predicts where the ball will land
+// once per tick and steers the paddle so that the bounce sends the ball
+// back toward the remaining bricks. With `fixed_point` set, plan() runs
+// in integer math and fixed_target() is exact.
+class Autopilot {
+  public:
+    Autopilot();
+
+    // recomputes the paddle centre the controller is heading for
+    void plan(
+      const pgl::GameObject& player, const BallObject& ball,
+      const std::vector<pgl::GameObject>& bricks,
+      float window_width, bool fixed_point = false);
+
+    auto target() const -> float { return paddle_target; }
+    auto fixed_target() const -> Fixed { return paddle_fixed_target; }
+    auto last_prediction() const -> const Prediction& { return prediction; }
+    // wall-clock cost of plan() (s)
+    auto query_time() const -> const RunningStats& { return timing; }
+
+  private:
+    void plan_fixed(
+      const pgl::GameObject& player, const BallObject& ball,
+      const std::vector<pgl::GameObject>& bricks,
+      float window_width);
+
+    Prediction   prediction;
+    float        paddle_target;
+    Fixed        paddle_fixed_target;
+    RunningStats timing;
+};
@@ -14,8 +14,7 @@ class BallObject : public pgl::GameObject {
     BallObject();
     BallObject(
       pgl::float2 pos, float radius,
-      pgl::float2 velocity,
-      pgl::Texture2D sprite
+      pgl::float2 velocity
     );
 
     auto move(float dt, unsigned int window_width) -> pgl::float2;
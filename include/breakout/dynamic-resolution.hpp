@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+
+// GpuTimer measures the GPU time of the commands between begin() and
+// end() with GL_TIME_ELAPSED queries. Results are collected a few frames
+// late from a ring of queries, so reading them never stalls the CPU on
+// the GPU. Needs a current GL context.
+class GpuTimer {
+  public:
+    GpuTimer();
+    ~GpuTimer();
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void begin();
+    void end();
+    // GPU time of the oldest measurement that finished since the last
+    // call (s), or a negative value when none did
+    auto poll() -> double;
+
+  private:
+    static constexpr unsigned int QUERIES = 4;
+
+    std::array<unsigned int, QUERIES> queries;
+    // measurements started and collected so far
+    unsigned int issued, collected;
+};
+
+// ResolutionController picks the resolution scale of the scene target
+// that keeps GPU time per frame within `budget` seconds. GPU time is
+// taken to grow with the pixel count, i.e. with the square of the scale;
+// the scale drops as soon as the smoothed time goes over budget, and only
+// rises back once there is clear headroom, so it doesn't oscillate.
+class ResolutionController {
+  public:
+    ResolutionController(double budget, float min_scale, float max_scale);
+
+    // feeds the GPU time of the last measured frame; returns the scale to
+    // render the next frames at
+    auto update(double gpu_time) -> float;
+    auto scale() const -> float { return current; }
+
+  private:
+    double budget;
+    float  low, high, current;
+    // exponential moving average of GPU time since the last scale change
+    double smoothed;
+    unsigned int samples;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <pangolin/game-object.hpp>
+#include <pangolin/resource-manager.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Tile codes of one generated slice of an endless level, using the same
+// convention as the .lvl files (0 empty, 1 solid, 2-5 coloured bricks).
+// Row 0 is the top of the chunk.
+struct TileChunk {
+  static constexpr unsigned int rows    = 8;
+  static constexpr unsigned int columns = 15;
+
+  std::uint64_t index;
+  std::array<unsigned char, rows * columns> tiles;
+};
+
+// ChunkGenerator produces TileChunks from a seed on a worker thread, in
+// index order and a few chunks ahead of demand. Chunks come from a fixed
+// pool and must be handed back with recycle() once consumed, so a run of
+// any length never allocates after start(). The thread is spawned by the
+// first start() and kept by later ones.
+class ChunkGenerator {
+  public:
+    static constexpr unsigned int pool_size = 4;
+
+    ChunkGenerator();
+    ~ChunkGenerator();
+
+    // (re)starts generation at chunk `first`; chunks of the previous run
+    // still pending are dropped
+    void start(std::uint64_t seed, std::uint64_t first);
+    void stop();
+
+    // next chunk in index order, or nullptr if it is not ready yet; never
+    // blocks the caller
+    auto poll() -> TileChunk*;
+    void recycle(TileChunk* chunk);
+
+    // deterministic: the same (seed, index) always yields the same tiles
+    static void generate(std::uint64_t seed, TileChunk& chunk);
+
+  private:
+    void run();
+
+    std::array<TileChunk, pool_size>  pool;
+    std::array<TileChunk*, pool_size> free_chunks;
+    std::array<TileChunk*, pool_size> ready; // FIFO ring
+    unsigned int free_count, ready_head, ready_count;
+    std::uint64_t seed, next_index;
+    // start() calls so far; a chunk generated for an earlier one is dropped
+    unsigned int epoch;
+    bool running;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+};
+
+// EndlessLevel is a vertically scrolling brick field streamed in fixed
+// size chunks. A constant number of chunks is resident at any time: the
+// one scrolling off the bottom is retired and its bricks are reused for
+// the next generated chunk, placed above the topmost one.
+class EndlessLevel {
+  public:
+    static constexpr unsigned int resident_chunks = 4;
+
+    // resident_chunks * TileChunk::rows * TileChunk::columns bricks; empty
+    // tiles and free slots are marked destroyed
+    std::vector<pgl::GameObject> bricks;
+    // always empty: scrolling solid bricks collide one by one, unmerged
+    std::vector<pgl::GameObject> colliders;
+
+    EndlessLevel();
+
+    // starts a new run; only its first chunks are laid out, the generator
+    // thread waits for the first update()
+    void init(unsigned int level_width, unsigned int level_height, std::uint64_t seed);
+    // scrolls the field and streams chunks in and out
+    void update(float dt);
+    // vertical distance travelled since init, in pixels
+    auto distance() const -> float { return scrolled; }
+
+  private:
+    void install(unsigned int slot, const TileChunk& chunk, float top);
+
+    ChunkGenerator generator;
+    std::uint64_t  seed;
+    // the generator is started for the current run
+    bool           streaming;
+    std::array<float, resident_chunks> chunk_top;
+    std::array<bool,  resident_chunks> occupied;
+    float unit_width, unit_height;
+    float view_height;
+    float scrolled;
+};
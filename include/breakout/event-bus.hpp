@@ -0,0 +1,57 @@
+#pragma once
+
+#include <breakout/power-up.hpp>
+#include <breakout/stats.hpp>
+
+#include <pgl-math/vector.hpp>
+
+#include <array>
+#include <cstddef>
+
+enum GameEventType {
+  EVENT_BRICK_DESTROYED,
+  EVENT_SOLID_HIT,
+  EVENT_POWERUP_COLLECTED,
+  EVENT_PADDLE_HIT,
+  GAME_EVENT_TYPES
+};
+
+// A side effect of the collision pass: what happened and the rectangle it
+// happened in (the brick, power-up or ball).
+struct GameEvent {
+  GameEventType type;
+  PowerUpType   power_up; // EVENT_POWERUP_COLLECTED only
+  pgl::float2   position;
+  pgl::float2   size;
+};
+
+// EventBus buffers the events of one simulation tick, so the collision
+// pass only records what happened and Game::dispatch_events runs audio,
+// power-ups, effects and particles over the whole batch afterwards.
+// Storage is fixed; events past `capacity` in one tick are dropped and
+// counted. end_tick() folds the tick's counts into per-type statistics.
+class EventBus {
+  public:
+    static constexpr std::size_t capacity = 64;
+
+    EventBus();
+
+    void emit(const GameEvent& event);
+    void end_tick();
+
+    auto begin() const -> const GameEvent* { return events.data(); }
+    auto end()   const -> const GameEvent* { return events.data() + used; }
+    auto count(GameEventType type) const -> unsigned int { return counts[type]; }
+    // events of `type` per tick, over all ticks so far
+    auto per_tick(GameEventType type) const -> const RunningStats& { return stats[type]; }
+    auto dropped() const -> std::size_t { return overflow; }
+
+  private:
+    std::array<GameEvent, capacity> events;
+    std::size_t used;
+    std::array<unsigned int, GAME_EVENT_TYPES> counts;
+    std::array<RunningStats, GAME_EVENT_TYPES> stats;
+    std::size_t overflow;
+};
+
+auto event_name(GameEventType type) -> const char*;
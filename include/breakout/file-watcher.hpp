@@ -0,0 +1,52 @@
+#pragma once
+
+#include <breakout/spsc-queue.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// A file of a watched directory that was written or replaced.
+struct FileChange {
+  // name within the directory, truncated to fit
+  char   name[64] = {};
+  // glfwGetTime() when the change was seen
+  double time = 0.0;
+};
+
+using FileChangeQueue = SpscQueue<FileChange, 64>;
+
+// FileWatcher reports files saved into a set of directories, from a
+// thread of its own blocked on inotify. Editors either rewrite a file in
+// place or write a new one and rename it over the old, so both closing a
+// file opened for writing and moving one in count as a change. Each
+// directory feeds its own queue, whose consumer picks the files it knows.
+// Linux only; elsewhere watch() fails.
+class FileWatcher {
+  public:
+    FileWatcher();
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // before start() only
+    auto watch(const char* directory, FileChangeQueue& changes) -> bool;
+    // `notify`, when given, is called from the watcher thread after each
+    // change, e.g. glfwPostEmptyEvent to wake an idle render loop
+    void start(void (*notify)() = nullptr);
+    void stop();
+
+  private:
+    struct Watch {
+      int descriptor;
+      FileChangeQueue* changes;
+    };
+
+    void run();
+
+    int fd;
+    std::vector<Watch> watches;
+    std::thread thread;
+    std::atomic<bool> running;
+    void (*notify)();
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <breakout/game.hpp>
+#include <breakout/fixed-point.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+// Integer counterparts of the float physics, used when Game::fixed_point
+// is set. The game state stays in floats; each function converts the
+// state it needs to Q16.16 (truncating), computes with integers only and
+// converts the result back (rounding to nearest). Every step is therefore a
+// pure function of the stored floats, and replays are bit-identical across
+// compilers and floating-point flags.
+
+// Seconds as Q0.32: a 1/120 s tick is off by 4e-9 relative, where Q16.16
+// would be off by 2e-4. Steps must stay below one second.
+inline auto fixed_time(float dt) -> std::int64_t {
+  return static_cast<std::int64_t>(dt * 4294967296.0f);
+}
+
+// distance covered at `velocity` during `dt` (from fixed_time)
+inline auto fixed_travel(Fixed velocity, std::int64_t dt) -> Fixed {
+  return Fixed::from_raw(static_cast<std::int32_t>((velocity.value() * dt) >> 32));
+}
+
+// BallObject::move
+void fixed_move_ball(BallObject& ball, float dt, unsigned int window_width);
+// position += velocity * dt, for falling power-ups
+void fixed_advance(pgl::GameObject& object, float dt);
+// the speed power-up: velocity *= 1.2
+void fixed_speed_up(BallObject& ball);
+// seconds -= dt, for power-up durations
+void fixed_count_down(float& seconds, float dt);
+// CheckCollision, AABB - AABB
+auto fixed_check_overlap(const pgl::GameObject& one, const pgl::GameObject& two) -> bool;
+auto fixed_box(const pgl::GameObject& object) -> FixedBox;
+auto fixed_circle(const BallObject& ball) -> FixedCircle;
+auto fixed_direction(Fixed2 target) -> Direction;
+
+// CheckCollision, circle - AABB. Inline since the brick loop calls it for
+// every brick with cached boxes.
+inline auto fixed_check_collision(const FixedCircle& ball, const FixedBox& box) -> Collision {
+  // closest point of the box to the circle's center; the same point as
+  // CheckCollision's clamp around the box center, without the halving
+  Fixed2 closest = { std::clamp(ball.center.x, box.low.x, box.high.x),
+                     std::clamp(ball.center.y, box.low.y, box.high.y) };
+  Fixed2 difference = closest - ball.center;
+
+  // compare squared lengths: no square root needed
+  std::int64_t r = ball.radius.value();
+  if (squared_length(difference) < static_cast<std::uint64_t>(r * r))
+    return {true, fixed_direction(difference), difference.to_float()};
+  return {false, UP, pgl::float2(0.0f, 0.0f)};
+}
+
+inline auto fixed_check_collision(const BallObject& ball, const pgl::GameObject& box) -> Collision {
+  return fixed_check_collision(fixed_circle(ball), fixed_box(box));
+}
+// reflects the ball off a brick and pushes it out by the penetration depth
+void fixed_bounce(BallObject& ball, Direction dir, pgl::float2 difference);
+// sends the ball back up from the paddle, steering by where it hit but
+// keeping its speed; `push` is the horizontal speed at the paddle's edge
+void fixed_deflect(BallObject& ball, const pgl::GameObject& paddle, float push);
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <pgl-math/vector.hpp>
+
+#include <cstdint>
+
+// Fixed is a Q16.16 number: 16 integer bits (up to +-32767) and steps of
+// 1/65536. Arithmetic only uses integer instructions, so results do not
+// depend on the compiler, the optimization level, FMA contraction or
+// -ffast-math. Converting from float scales by 2^16 and truncates toward
+// zero. Converting to float rounds to the nearest float: exact while
+// |value| < 256, half a float step off beyond that, as on screen
+// coordinates. Both conversions are correctly rounded IEEE operations,
+// so they give the same result on every build. Products are taken in 64
+// bits and narrowed, so one out of range wraps around (as C++20 defines
+// the narrowing) instead of being undefined.
+class Fixed {
+  public:
+    static constexpr int fraction_bits = 16;
+    static constexpr std::int32_t one = 1 << fraction_bits;
+
+    constexpr Fixed() : raw(0) { }
+
+    static constexpr auto from_raw(std::int32_t raw) -> Fixed {
+      Fixed f;
+      f.raw = raw;
+      return f;
+    }
+    static constexpr auto from_int(int value) -> Fixed {
+      return from_raw(static_cast<std::int32_t>(static_cast<std::int64_t>(value) * one));
+    }
+    // numerator / denominator, rounded toward zero
+    static constexpr auto ratio(std::int64_t numerator, std::int64_t denominator) -> Fixed {
+      return from_raw(static_cast<std::int32_t>(numerator * one / denominator));
+    }
+    static auto from_float(float value) -> Fixed {
+      return from_raw(static_cast<std::int32_t>(value * 65536.0f));
+    }
+
+    auto to_float() const -> float { return static_cast<float>(raw) * (1.0f / 65536.0f); }
+    constexpr auto value() const -> std::int32_t { return raw; }
+
+    constexpr auto operator-() const -> Fixed { return from_raw(-raw); }
+    constexpr auto operator+(Fixed other) const -> Fixed { return from_raw(raw + other.raw); }
+    constexpr auto operator-(Fixed other) const -> Fixed { return from_raw(raw - other.raw); }
+    constexpr auto operator*(Fixed other) const -> Fixed {
+      return from_raw(static_cast<std::int32_t>(
+        (static_cast<std::int64_t>(raw) * other.raw) >> fraction_bits));
+    }
+    constexpr auto operator/(Fixed other) const -> Fixed {
+      return from_raw(static_cast<std::int32_t>(
+        static_cast<std::int64_t>(raw) * one / other.raw));
+    }
+    constexpr auto operator*(int factor) const -> Fixed {
+      return from_raw(static_cast<std::int32_t>(static_cast<std::int64_t>(raw) * factor));
+    }
+    constexpr auto operator/(int divisor) const -> Fixed { return from_raw(raw / divisor); }
+    constexpr auto operator+=(Fixed other) -> Fixed& { raw += other.raw; return *this; }
+    constexpr auto operator-=(Fixed other) -> Fixed& { raw -= other.raw; return *this; }
+
+    constexpr auto operator==(const Fixed&) const -> bool = default;
+    constexpr auto operator<=>(const Fixed&) const = default;
+
+  private:
+    std::int32_t raw;
+};
+
+constexpr auto abs(Fixed value) -> Fixed { return value < Fixed() ? -value : value; }
+
+// Floor of the square root of a 64-bit integer, bit by bit.
+constexpr auto isqrt(std::uint64_t value) -> std::uint64_t {
+  std::uint64_t root = 0;
+  std::uint64_t bit = std::uint64_t(1) << 62;
+  while (bit > value)
+    bit >>= 2;
+  while (bit != 0) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+struct Fixed2 {
+  Fixed x, y;
+
+  static auto from_float(pgl::float2 v) -> Fixed2 {
+    return { Fixed::from_float(v.x), Fixed::from_float(v.y) };
+  }
+  auto to_float() const -> pgl::float2 { return pgl::float2(x.to_float(), y.to_float()); }
+
+  constexpr auto operator+(Fixed2 o) const -> Fixed2 { return { x + o.x, y + o.y }; }
+  constexpr auto operator-(Fixed2 o) const -> Fixed2 { return { x - o.x, y - o.y }; }
+  constexpr auto operator*(Fixed s) const -> Fixed2 { return { x * s, y * s }; }
+  constexpr auto operator/(int d) const -> Fixed2 { return { x / d, y / d }; }
+};
+
+// |v|^2 in Q32.32, which can't overflow for any pair of Q16.16 values
+constexpr auto squared_length(Fixed2 v) -> std::uint64_t {
+  std::int64_t x = v.x.value(), y = v.y.value();
+  return static_cast<std::uint64_t>(x * x) + static_cast<std::uint64_t>(y * y);
+}
+
+constexpr auto length(Fixed2 v) -> Fixed {
+  return Fixed::from_raw(static_cast<std::int32_t>(isqrt(squared_length(v))));
+}
+
+// collision shapes: an axis-aligned box by its corners and a circle
+struct FixedBox {
+  Fixed2 low, high;
+};
+
+struct FixedCircle {
+  Fixed2 center;
+  Fixed  radius;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <breakout/soft-image.hpp>
+#include <breakout/stats.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// FrameCapture saves the frames rendered into the current framebuffer as
+// an image sequence, directory/frame-000000.ppm and up. Each capture()
+// only queues a glReadPixels into one of a ring of pixel-buffer objects;
+// the pixels are mapped a few frames later, once their fence has
+// signalled, so the GPU never has to finish a frame early for us. Mapped
+// frames are copied into a fixed pool of images that a worker thread
+// encodes. If the worker falls a whole pool behind, capture() waits for
+// it rather than drop frames, since golden-image comparisons need every
+// frame; the time spent waiting is reported.
+class FrameCapture {
+  public:
+    static constexpr unsigned int ring_size = 3;
+    static constexpr unsigned int pool_size = 8;
+
+    FrameCapture(int width, int height, std::string directory);
+    ~FrameCapture();
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // call after rendering a frame, before swapping buffers
+    void capture();
+    // collects the frames still in flight and waits until all are written
+    void finish();
+
+    auto frames() const -> unsigned int { return issued; }
+    auto failures() const -> unsigned int { return failed; }
+    // render thread time spent in capture() (s)
+    auto capture_time() const -> const RunningStats& { return cost; }
+    // part of it spent waiting for the GPU or for the encoder (s)
+    auto stall_time() const -> double { return stalled; }
+
+  private:
+    struct Slot {
+      unsigned int pbo = 0;
+      void* fence = nullptr;
+      unsigned int frame = 0;
+    };
+    struct Encoded {
+      SoftImage* image;
+      unsigned int frame;
+    };
+
+    void collect(Slot& slot);
+    void encode();
+
+    int width, height;
+    std::string directory;
+    std::array<Slot, ring_size> slots;
+    unsigned int issued, collected;
+    RunningStats cost;
+    double stalled;
+
+    std::array<SoftImage, pool_size> pool;
+    std::vector<SoftImage*> free_images;
+    std::deque<Encoded> pending;
+    unsigned int failed;
+    bool quit;
+    std::mutex mutex;
+    std::condition_variable ready, released;
+    std::thread worker;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <breakout/stats.hpp>
+
+#include <cstdint>
+
+// FramePacer caps the render loop at a target frame rate and keeps the
+// numbers that show whether pacing works: the interval between presented
+// frames, how many frames were skipped because nothing on screen changed,
+// and the render thread's CPU use split between idle and active frames.
+// A rate of zero leaves pacing to vsync alone.
+class FramePacer {
+  public:
+    explicit FramePacer(double rate);
+
+    // sleeps until the next frame is due; returns at once without a cap
+    void wait();
+    // seconds until the next frame is due, never negative
+    auto remaining() const -> double;
+
+    // ends a loop iteration: `presented` tells whether a frame was drawn
+    // and swapped, `idle` whether the loop was waiting for a change
+    void end_frame(bool presented, bool idle);
+
+    auto rate() const -> double { return period > 0.0 ? 1.0 / period : 0.0; }
+    // interval between consecutive presented frames (s)
+    auto frame_times() const -> const RunningStats& { return intervals; }
+    auto presented_frames() const -> std::uint64_t { return presented; }
+    auto skipped_frames() const -> std::uint64_t { return skipped; }
+    // fraction of one core used by the render thread while idle / active
+    auto idle_cpu() const -> double;
+    auto active_cpu() const -> double;
+
+  private:
+    double period;
+    double next;
+    double last_present;
+    bool previous_presented;
+    RunningStats intervals;
+    std::uint64_t presented, skipped;
+    // wall and thread CPU time at the last end_frame, and their sums per mode
+    double wall_mark, cpu_mark;
+    double idle_wall, idle_cpu_time;
+    double active_wall, active_cpu_time;
+};
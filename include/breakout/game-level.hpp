@@ -3,18 +3,43 @@
 #include <pangolin/game-object.hpp>
 #include <pangolin/resource-manager.hpp>
 
+#include <cstddef>
 #include <vector>
-#include <fstream>
-#include <sstream>
+
+// Tile codes of a level, row-major, as written in its .lvl file: 0 is
+// empty, 1 a solid brick and any other code a brick of some color.
+// Codes above 255 are stored as 255, which draws the same.
+struct LevelTiles {
+  unsigned int width  = 0;
+  unsigned int height = 0;
+  std::vector<unsigned char> codes;
+  // non-zero codes
+  std::size_t bricks = 0;
+
+  auto at(unsigned int x, unsigned int y) const -> unsigned int { return codes[std::size_t(y) * width + x]; }
+};
+
+// Parses .lvl text in one pass: rows of whitespace-separated codes, one
+// row per line, blank lines ignored. Every row must be as wide as the
+// first. Reports the first malformed code or ragged row with `name` and
+// its line number, and returns false; an empty level is an error too.
+auto parse_level(const char* begin, const char* end, const char* name, LevelTiles& tiles) -> bool;
 
 class GameLevel {
   public:
     // level state
     std::vector<pgl::GameObject> bricks;
+    // solid bricks merged into as few boxes as possible: runs along a row,
+    // then identical runs stacked over consecutive rows. The solid entries
+    // of `bricks` are only drawn; collisions are tested against these.
+    std::vector<pgl::GameObject> colliders;
+    // solid bricks before the merge
+    unsigned int solid_count = 0;
     // constructor
     GameLevel() { }
-    // loads level from file
-    void load(const char* file, unsigned int levelWidth, unsigned int levelHeight);
+    // loads level from file; false, and no bricks, if it can't be read or
+    // parsed
+    bool load(const char* file, unsigned int levelWidth, unsigned int levelHeight);
     // render level
     void draw(pgl::render2D::SpriteRenderer &renderer);
     // check if the level is completed (all non-solid tiles are destroyed)
@@ -22,8 +47,6 @@ class GameLevel {
 
   private:
     // initialize level from tile data
-    void init(
-			std::vector<std::vector<unsigned int>>& tile_data,
-			unsigned int level_width, unsigned int level_height
-		);
+    void init(const LevelTiles& tiles, unsigned int level_width, unsigned int level_height);
+    void merge_solids(const LevelTiles& tiles, unsigned int level_width, unsigned int level_height);
 };
@@ -3,7 +3,6 @@
 #include <pangolin/resource-manager.hpp>
 #include <pangolin/glfw-support.hpp>
 #include <pangolin/sprite-renderer.hpp>
-#include <pangolin/particle-generator.hpp>
 #include <pangolin/text-renderer.hpp>
 #include <pangolin/game-object.hpp>
 
@@ -12,12 +11,26 @@
 #include <pgl-math/algorithms.hpp>
 
 #include <breakout/game-level.hpp>
+#include <breakout/endless-level.hpp>
 #include <breakout/ball-object.hpp>
 #include <breakout/post-processor.hpp>
 #include <breakout/power-up.hpp>
+#include <breakout/input-queue.hpp>
+#include <breakout/event-bus.hpp>
+#include <breakout/autopilot.hpp>
+#include <breakout/stats.hpp>
+#include <breakout/alloc-tracker.hpp>
+#include <breakout/fixed-point.hpp>
+#include <breakout/shader-program.hpp>
+#include <breakout/file-watcher.hpp>
+#include <breakout/latency-probe.hpp>
+#include <breakout/shader-cache.hpp>
 
 #include <irrKlang.h>
 #include <algorithm>
+#include <array>
+#include <cstdio>
+#include <string>
 #include <tuple>
 
 enum GameState {
@@ -38,34 +51,193 @@ const unsigned int GOOD_RATE = 30;
 
 using Collision = std::tuple<bool, Direction, pgl::float2>;
 
+// Post-processing switches driven by the simulation.
+struct EffectState {
+  bool confuse = false;
+  bool chaos   = false;
+  bool shake   = false;
+};
+
+// WorldSnapshot is an immutable copy of everything the renderer needs,
+// published by the simulation thread after each tick. Positions of the
+// ball and paddle at the start of the tick are kept alongside so the
+// renderer can interpolate between ticks.
+struct WorldSnapshot {
+  std::vector<pgl::GameObject> bricks;
+  std::vector<PowerUp>         power_ups;
+  pgl::GameObject player;
+  BallObject      ball;
+  pgl::float2     player_previous;
+  pgl::float2     ball_previous;
+  EffectState     effects;
+  GameState       state = GAME_MENU;
+  unsigned int    level = 0;
+  unsigned int    lives = 0;
+  // simulation time at the end of the tick this snapshot describes
+  double          time = 0.0;
+  // when the last hot-reloaded level file was saved (glfwGetTime), 0 if none
+  double          reloaded = 0.0;
+  // the latest key event applied, up to this snapshot
+  LatencyStamps   input;
+};
+
+// What the last rendered frame showed; Game::needs_redraw compares the
+// next snapshot against it.
+struct FrameSummary {
+  bool         valid = false;
+  GameState    state = GAME_MENU;
+  unsigned int level = 0;
+  unsigned int lives = 0;
+  pgl::float2  player;
+  pgl::float2  ball;
+  float        player_width = 0.0f;
+  double       reloaded = 0.0;
+};
+
+// A line of text drawn over a finished frame, after post-processing
+struct TextLine {
+  const std::string* text;
+  float       x, y, scale;
+  pgl::float3 color;
+};
+
+// The text Game::render draws over a frame of `world`, shared with the
+// software renderer: up to two lines, returning how many. The lives
+// counter is formatted into `lives`, which short strings keep off the
+// heap.
+auto frame_text(const WorldSnapshot& world, unsigned int height, std::string& lives,
+                std::array<TextLine, 2>& lines) -> unsigned int;
+
 bool CheckCollision(pgl::GameObject& one, pgl::GameObject& two);
 auto CheckCollision(BallObject& one, pgl::GameObject& two) -> Collision;
 auto vector_direction(pgl::float2 target) -> Direction;
 bool should_spawn(unsigned int chance);
-void ActivatePowerUp(PowerUp& powerUp);
-bool isOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string type);
+void ActivatePowerUp(PowerUpType type, EffectState& effects, bool fixed_point = false);
+bool isOtherPowerUpActive(const std::vector<PowerUp>& powerUps, PowerUpType type);
+void play_sound(const char* file, bool loop = false);
 
 class Game {
   public:
     std::vector<PowerUp>   power_ups;
     std::vector<GameLevel> levels;
+    // procedurally generated level, selected after the hand-made ones
+    EndlessLevel  endless;
+    std::uint64_t endless_seed;
     unsigned int level;
     GameState state;
     bool keys[1024];
     bool key_processed[1024];
     unsigned int width, height;
     unsigned int lives;
+    // timestamped key events, filled by key_callback and consumed per tick
+    InputQueue   input_queue;
+    // delay between an event's timestamp and the tick that applied it (s)
+    RunningStats input_latency;
+    // stamps of the latest key event, up to the snapshot (simulation
+    // thread), then up to the post-processing of the frame drawn from it
+    // (render thread)
+    LatencyStamps input_stamps, frame_latency;
+    // clock of the simulation's stamps, glfwGetTime when a window reports
+    // latencies; headless replays leave it unset and stamp nothing, so
+    // ticks never read a wall clock
+    double (*latency_clock)();
+    // drawn over the frame when set, render thread
+    const LatencyHistogram* latency_overlay;
+    // side effects of the current tick's collisions
+    EventBus     events;
+    // events the render thread turns into particles, forwarded when
+    // `burst_events` is set: by load_resources, or by whoever drives a
+    // SoftwareRenderer instead
+    SpscQueue<GameEvent, 256> render_events;
+    bool         burst_events;
+    // no sound at all: headless replays, whose timings must not depend
+    // on whether the machine has an audio device
+    bool         muted;
+    // post-processing effects requested by the simulation
+    EffectState  effect_state;
+    // when set, the paddle is driven by `pilot` instead of the keyboard
+    bool         autopilot;
+    Autopilot    pilot;
+    // run the physics in integer fixed-point math (see fixed-physics.hpp)
+    // so that a game plays out bit for bit the same on every build
+    bool         fixed_point;
+    // bricks() then colliders() as fixed-point boxes, and the level they
+    // were built for
+    std::vector<FixedBox> fixed_bricks;
+    unsigned int          fixed_bricks_level;
+    // texture binds issued per rendered frame, text excluded
+    RunningStats texture_binds;
+    // GL calls of each kind per rendered frame, see DriverCall
+    std::array<RunningStats, DRIVER_CALLS> gl_calls;
+    // scene render target: MSAA samples (0 for none) and resolution
+    // relative to the output, which is the window's framebuffer
+    unsigned int msaa_samples;
+    float        render_scale;
+    unsigned int output_width, output_height;
+    // framebuffer the frames end up in, 0 for the window's own
+    unsigned int output_framebuffer;
+    // where linked shader programs are cached across launches, empty to
+    // compile them all from source; see ShaderCache
+    std::string  shader_cache_directory;
+    // hot reload: files saved into resources/levels and resources/shaders,
+    // and the delay from a save to the first frame presented with it (s)
+    FileChangeQueue level_changes;
+    FileChangeQueue shader_changes;
+    RunningStats    reload_latency;
+    // render thread time spent rebuilding each reloaded shader (s); one
+    // longer than a frame is a dropped frame
+    RunningStats    reload_stall;
+    // save time of the last level swapped in (simulation thread) and of the
+    // oldest shader swapped in but not presented yet (render thread)
+    double          level_reloaded, shader_reloaded;
+    // render thread: the last frame drawn, and how long its particles live on
+    FrameSummary last_frame;
+    float        particle_life;
 
     Game(unsigned int width, unsigned int height);
     ~Game();
 
     void init();
+    void load_resources();
+    void init_world();
     void update(float dt);
-    void render();
+    void render(WorldSnapshot& world, float alpha, float dt);
+    void draw_latency_overlay();
+    // false when drawing `world` would reproduce the last rendered frame:
+    // nothing moved, no animated effect is on and no particle is alive
+    auto needs_redraw(const WorldSnapshot& world) const -> bool;
+    // render thread, after the swap of a frame drawn from `world`
+    void presented(const WorldSnapshot& world, double time);
+    // both take effect at once when resources are loaded
+    void set_render_scale(float scale);
+    void resize_output(unsigned int width, unsigned int height, unsigned int framebuffer = 0);
+    void snapshot(WorldSnapshot& world, double time);
     void process_collisions();
-    void process_input(float dt);
+    void dispatch_events();
+    void process_input(float dt, double time);
+    void apply_input(const InputEvent& event);
+    void move_player(float dt);
+    void move_player_fixed(float dt);
+    void update_fixed_bricks();
+    void drive_autopilot(double time);
     void reset_level();
+    // simulation thread: reparses changed level files, at a tick boundary
+    void apply_level_changes();
+    // render thread: rebuilds the program of the oldest shader saved, at
+    // most one per call; true if it was swapped in
+    auto apply_shader_changes() -> bool;
+    auto is_endless() const -> bool { return level == levels.size(); }
+    auto level_count() const -> unsigned int { return levels.size() + 1; }
+    // bricks of the level being played
+    auto bricks() -> std::vector<pgl::GameObject>&;
+    // merged solid colliders of the level being played, empty for the
+    // endless level whose solid bricks scroll and collide one by one
+    auto colliders() -> std::vector<pgl::GameObject>&;
+    // FNV-1a of the simulation state: paddle, ball, bricks, power-ups,
+    // lives, level and state. In fixed-point mode, equal hashes from two
+    // machines mean they played the same game.
+    auto state_hash() -> std::uint64_t;
     void reset_player();
-    void spawn_power_ups(pgl::GameObject& block);
+    void spawn_power_ups(pgl::float2 position);
     void update_power_ups(float dt);
 };
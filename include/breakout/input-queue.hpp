@@ -0,0 +1,14 @@
+#pragma once
+
+#include <breakout/spsc-queue.hpp>
+
+// InputEvent is a single key transition as reported by GLFW, stamped
+// with the time (glfwGetTime) at which key_callback received it.
+struct InputEvent {
+  int    key;
+  int    action;
+  double time;
+};
+
+// key_callback pushes events, the simulation pops them once per tick.
+using InputQueue = SpscQueue<InputEvent, 256>;
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <breakout/stats.hpp>
+
+#include <array>
+#include <cstdint>
+
+// Stages of a key event's way from key_callback to the screen, in order.
+enum LatencyStage {
+  STAGE_EVENT,  // key_callback received it
+  STAGE_INPUT,  // process_input applied it
+  STAGE_UPDATE, // the tick's update finished and its snapshot was taken
+  STAGE_RENDER, // the render thread started drawing that snapshot
+  STAGE_SCENE,  // PostProcessor::end_render resolved the scene
+  STAGE_POST,   // PostProcessor::render and the text were submitted
+  STAGE_SWAP,   // glfwSwapBuffers returned
+  STAGE_GPU,    // the GPU finished the frame
+  LATENCY_STAGES
+};
+
+auto latency_stage_name(LatencyStage stage) -> const char*;
+
+// glfwGetTime() at each stage reached so far by the latest key event
+// applied; `sequence` tells events apart, 0 before the first one.
+struct LatencyStamps {
+  unsigned int sequence = 0;
+  std::array<double, LATENCY_STAGES> time = {};
+};
+
+// LatencyHistogram counts latencies in 1 ms buckets, the last of which
+// takes everything longer. It keeps the totals since the start, and the
+// counts of the latest `window` samples for a rolling view.
+class LatencyHistogram {
+  public:
+    static constexpr unsigned int buckets = 100;
+    static constexpr unsigned int window  = 240;
+
+    LatencyHistogram();
+
+    void add(double latency);
+
+    auto count() const -> unsigned int { return samples; }
+    auto recent(unsigned int bucket) const -> unsigned int { return recent_counts[bucket]; }
+    auto total(unsigned int bucket) const -> unsigned int { return total_counts[bucket]; }
+    // upper edge of the bucket holding that fraction of the latest
+    // samples (s), 0 without samples
+    auto percentile(double fraction) const -> double;
+    // "from_ms,to_ms,frames,recent_frames" per bucket
+    auto save_csv(const char* file) const -> bool;
+
+  private:
+    std::array<unsigned int, buckets> recent_counts, total_counts;
+    std::array<unsigned char, window> latest;
+    unsigned int samples;
+};
+
+// LatencyProbe completes the stamps of the first frame presented after
+// each key event. GPU completion comes from a GL_TIMESTAMP query issued
+// after the swap, read back a few frames late and moved onto the
+// glfwGetTime() clock, so the probe never waits on the GPU. What happens
+// after the GPU is done, compositing and scan-out, is beyond what GL can
+// see. Needs a current GL context.
+class LatencyProbe {
+  public:
+    LatencyProbe();
+    ~LatencyProbe();
+    LatencyProbe(const LatencyProbe&) = delete;
+    LatencyProbe& operator=(const LatencyProbe&) = delete;
+
+    // after glfwSwapBuffers returned at `swap_time`, for a frame drawn
+    // with `stamps`
+    void presented(const LatencyStamps& stamps, double swap_time);
+
+    // key_callback to GPU completion
+    auto histogram() const -> const LatencyHistogram& { return latencies; }
+    // time from the stage before to `stage` (s)
+    auto stage(LatencyStage stage) const -> const RunningStats& { return stages[stage]; }
+    auto dropped() const -> unsigned int { return lost; }
+
+  private:
+    static constexpr unsigned int QUERIES = 4;
+
+    struct Pending {
+      LatencyStamps stamps;
+      // GL clock (ns) and glfwGetTime() (s) when the query was issued
+      std::int64_t gl_time;
+      double       time;
+    };
+
+    void collect();
+
+    std::array<unsigned int, QUERIES> queries;
+    std::array<Pending, QUERIES> pending;
+    unsigned int issued, collected;
+    unsigned int last_sequence, lost;
+    LatencyHistogram latencies;
+    std::array<RunningStats, LATENCY_STAGES> stages;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// MappedFile is a read-only view of a whole file. Large files are mapped
+// into memory where the platform allows it; small ones, and all of them
+// elsewhere, are read into a buffer. The view stays valid as long as the
+// object lives.
+class MappedFile {
+  public:
+    explicit MappedFile(const char* file);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // false if the file couldn't be opened; an empty file is open
+    auto is_open() const -> bool { return open; }
+    auto data() const -> const char* { return begin; }
+    auto size() const -> std::size_t { return length; }
+
+  private:
+    bool open;
+    const char* begin;
+    std::size_t length;
+    // mapped: unmapped on destruction; otherwise the file contents
+    bool mapped;
+    std::vector<char> buffer;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <breakout/shader-program.hpp>
+
+#include <pangolin/game-object.hpp>
+#include <pangolin/texture.hpp>
+#include <pgl-math/vector.hpp>
+
+#include <random>
+#include <vector>
+
+// Particles alive at once
+const unsigned int PARTICLE_COUNT = 500;
+// Particles spawned where a brick breaks
+const unsigned int BURST_PARTICLES = 8;
+// Particles the moving ball leaves behind each frame
+const unsigned int TRAIL_PARTICLES = 2;
+
+// ParticlePool simulates what pgl::ParticleGenerator did: a fixed pool of
+// particles respawned around an object, fading out over one second. Its
+// random numbers come from its own generator, so the render thread never
+// touches the simulation's rand() sequence. It draws nothing: see
+// ParticleSystem and SoftwareRenderer.
+class ParticlePool {
+  public:
+    struct Particle {
+      pgl::float2 position, velocity;
+      float r, g, b, a;
+      float life;
+    };
+
+    explicit ParticlePool(unsigned int amount);
+
+    void update(float dt, const pgl::GameObject& object, unsigned int new_particles,
+                pgl::float2 offset = pgl::float2(0.0f, 0.0f));
+    // live ones have life > 0
+    auto particles() const -> const std::vector<Particle>& { return pool; }
+
+  private:
+    auto first_unused() -> unsigned int;
+    void respawn(Particle& particle, const pgl::GameObject& object, pgl::float2 offset);
+
+    std::vector<Particle> pool;
+    unsigned int last_used;
+    std::minstd_rand random;
+};
+
+// ParticleSystem behaves like pgl::ParticleGenerator: a fixed pool of
+// particles respawned around an object, fading out over one second. It
+// draws all live particles of its ParticlePool with a single instanced
+// call, offset and color coming from a per-instance attribute buffer
+// rather than two uniforms per particle.
+class ParticleSystem {
+  public:
+    ParticleSystem(unsigned int program, pgl::Texture2D texture, unsigned int amount);
+    ~ParticleSystem();
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    void update(float dt, const pgl::GameObject& object, unsigned int new_particles,
+                pgl::float2 offset = pgl::float2(0.0f, 0.0f));
+    void draw();
+    // switches to another linked build of particle.vs/.fs
+    void set_program(unsigned int program);
+
+  private:
+    // per-instance attributes
+    struct Instance {
+      float x, y;
+      float r, g, b, a;
+    };
+
+    void configure_program();
+
+    ShaderProgram shader;
+    pgl::Texture2D texture;
+    ParticlePool particles;
+    std::vector<Instance> instances;
+    unsigned int vao, quad_vbo, instance_vbo;
+};
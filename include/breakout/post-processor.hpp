@@ -7,12 +7,16 @@
 #include <pangolin/sprite-renderer.hpp>
 #include <pangolin/shader.hpp>
 
+#include <breakout/shader-program.hpp>
+
 #include <iostream>
 
 // PostProcessor hosts all PostProcessing effects for the Breakout
-// Game. It renders the game on a textured quad after which one can
-// enable specific effects by enabling either the Confuse, Chaos or
-// Shake boolean.
+// Game. It renders the game on a textured quad; the Confuse, Chaos and
+// Shake effects and their clock come from the Frame uniform block.
+// The scene is drawn into an offscreen target of `scale` times the output
+// size with `samples` MSAA samples (0 renders straight into the texture);
+// the final pass stretches it over the output with linear filtering.
 // It is required to call BeginRender() before rendering the game
 // and EndRender() after rendering the game for the class to work.
 
@@ -21,25 +25,43 @@ class PostProcessor {
     // state
     pgl::Shader post_processing_shader;
     pgl::Texture2D texture;
+    // output size, in framebuffer pixels
     unsigned int width, height;
-    // options
-    bool confuse, chaos, shake;
     // constructor
     PostProcessor(
       pgl::Shader& shader,
-      unsigned int width, unsigned int height
+      unsigned int width, unsigned int height,
+      unsigned int samples = 4, float scale = 1.0f
     );
+    // resolution of the scene target relative to the output, in (0, 1]
+    void set_scale(float scale);
+    // the final pass draws into `framebuffer`, 0 for the window's own
+    void set_output_size(unsigned int width, unsigned int height, unsigned int framebuffer = 0);
+    auto get_scale() const -> float { return scale; }
+    auto get_samples() const -> unsigned int { return samples; }
+    auto scene_width() const -> unsigned int { return target_width; }
+    auto scene_height() const -> unsigned int { return target_height; }
     // prepares the postprocessor's framebuffer operations before rendering the game
     void begin_render();
     // should be called after rendering the game, so it stores all the rendered data into a texture object
     void end_render();
     // renders the PostProcessor texture quad (as a screen-encompassing large sprite)
-    void render(float time);
+    void render();
+    // switches to another linked build of postprocessor.vs/.fs
+    void set_program(unsigned int program);
   private:
     // render state
     unsigned int MSFBO, FBO; // MSFBO = Multisampled FBO. FBO is regular, used for blitting MS color-buffer to texture
     unsigned int RBO; // RBO is used for multisampled color buffer
     unsigned int VAO;
+    unsigned int output;
+    unsigned int samples;
+    float scale;
+    unsigned int target_width, target_height;
+    // kernels, sampler and uniform block of the current program
+    void init_uniforms();
+    // (re)allocates the scene targets at the current scale
+    void allocate_targets();
     // initialize quad for rendering postprocessing texture
     void init_render_data();
 };
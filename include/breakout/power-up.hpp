@@ -8,8 +8,6 @@
  ******************************************************************/
 #pragma once
 
-#include <string>
-
 #include <glad/glad.h>
 
 #include <pangolin/game-object.hpp>
@@ -20,24 +18,32 @@ const pgl::float2 POWERUP_SIZE(60.0f, 20.0f);
 // Velocity a PowerUp block has when spawned
 const pgl::float2 VELOCITY(0.0f, 150.0f);
 
+enum PowerUpType {
+  POWERUP_SPEED,
+  POWERUP_STICKY,
+  POWERUP_PASS_THROUGH,
+  POWERUP_PAD_SIZE_INCREASE,
+  POWERUP_CONFUSE,
+  POWERUP_CHAOS,
+  POWERUP_TYPES
+};
 
 // PowerUp inherits its state and rendering functions from
 // GameObject but also holds extra information to state its
 // active duration and whether it is activated or not. 
-// The type of PowerUp is stored as a string.
+// The type of PowerUp is stored as a PowerUpType.
 class PowerUp : public pgl::GameObject {
   public:
     // powerup state
-    std::string Type;
+    PowerUpType Type;
     float       Duration;	
     bool        Activated;
     // constructor
     PowerUp(
-      std::string type, pgl::float3 color,
-      float duration, pgl::float2 position,
-      pgl::Texture2D texture) 
+      PowerUpType type, pgl::float3 color,
+      float duration, pgl::float2 position)
       : GameObject(position, POWERUP_SIZE,
-                   texture, color, VELOCITY),
+                   pgl::Texture2D(), color, VELOCITY),
       Type(type), Duration(duration),
       Activated() { }
 };
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <breakout/game.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Session is a recorded game: the settings it started with and every key
+// transition, stamped in seconds since the first tick. Stored as text:
+//
+//   level 2          level selected when the menu opens
+//   seed 42          std::srand seed (power-up spawns)
+//   endless 0x5EED   endless level seed
+//   autopilot 1      whether the autopilot plays
+//   fixed_point 1    whether the physics run in fixed-point math
+//   rate 120         simulation ticks per second
+//   ticks 21600      length of the session
+//   event 1.25 257 1 time, GLFW key, GLFW action
+//
+// Lines starting with '#' are comments.
+struct Session {
+  unsigned int  level     = 0;
+  unsigned int  seed      = 1;
+  std::uint64_t endless   = 0x5EEDB10C;
+  bool          autopilot = false;
+  bool          fixed_point = false;
+  double        rate      = 120.0;
+  unsigned int  ticks     = 0;
+  std::vector<InputEvent> events;
+};
+
+auto load_session(const char* file, Session& session) -> bool;
+auto save_session(const char* file, const Session& session) -> bool;
+
+// SessionReplay drives a headless game through a session at its fixed
+// rate: each tick queues the events that are due, then runs the same
+// process_input and update as the simulation thread. `game` must have
+// been set up with init_world().
+class SessionReplay {
+  public:
+    SessionReplay(Game& game, const Session& session);
+
+    // runs the next tick; false once the session is over
+    auto tick() -> bool;
+    auto ticks() const -> unsigned int { return current; }
+
+  private:
+    Game& game;
+    const Session& session;
+    std::size_t next_event;
+    unsigned int current;
+};
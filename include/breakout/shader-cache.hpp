@@ -0,0 +1,48 @@
+#pragma once
+
+#include <breakout/stats.hpp>
+
+#include <cstdint>
+#include <string>
+
+// ShaderCache saves linked programs to disk with glGetProgramBinary, one
+// file per program name, so later launches load them with glProgramBinary
+// instead of compiling GLSL. An entry is keyed by a hash of both sources
+// and of the GL vendor, renderer and version strings: once a shader is
+// edited or the driver changes, it is stale, and the program is compiled
+// again and the entry overwritten. An entry the driver refuses to load
+// is treated the same. Without a directory, or with a driver that offers
+// no binary formats, every program is compiled. Needs a current GL
+// context.
+class ShaderCache {
+  public:
+    // `directory` is created when missing; an empty one disables caching
+    explicit ShaderCache(std::string directory);
+
+    // a linked program built from the two files, 0 on failure
+    auto load(const char* name, const char* vertex_file, const char* fragment_file) -> unsigned int;
+
+    auto enabled() const -> bool { return supported; }
+    // time spent on each program compiled from source, and on each one
+    // loaded from the cache (s)
+    auto compile_time() const -> const RunningStats& { return compiled; }
+    auto load_time() const -> const RunningStats& { return loaded; }
+    // entries found stale or rejected by the driver
+    auto invalidated() const -> unsigned int { return stale; }
+
+  private:
+    auto entry(const char* name) const -> std::string;
+    auto load_binary(const std::string& file, std::uint64_t key) -> unsigned int;
+    void save_binary(const std::string& file, std::uint64_t key, unsigned int program);
+
+    std::string   directory;
+    // hash of the driver strings, the start of every key
+    std::uint64_t driver;
+    bool          supported;
+    RunningStats  compiled, loaded;
+    unsigned int  stale;
+};
+
+// $XDG_CACHE_HOME/breakout/shaders, or ~/.cache/breakout/shaders; empty
+// when neither variable is set
+auto default_shader_cache() -> std::string;
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <pgl-math/vector.hpp>
+
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Kinds of GL calls counted per frame by the game's own renderers.
+// pangolin's sprite and text renderers issue theirs uncounted, but for
+// the background's texture, which Game::render counts.
+enum DriverCall {
+  CALL_DRAW,    // glDraw*
+  CALL_BIND,    // program and vertex array binds
+  CALL_TEXTURE, // texture binds
+  CALL_UNIFORM, // glUniform*
+  CALL_UPLOAD,  // glBuffer(Sub)Data
+  DRIVER_CALLS
+};
+
+// counters since the last reset, render thread only
+auto driver_calls() -> std::array<unsigned int, DRIVER_CALLS>&;
+inline void count_call(DriverCall call, unsigned int n = 1) { driver_calls()[call] += n; }
+auto driver_call_name(DriverCall call) -> const char*;
+
+// ShaderProgram resolves every active uniform of a linked program once,
+// so that setting one later is a single glUniform call instead of a
+// glGetUniformLocation string lookup. Setters act on the program in use.
+class ShaderProgram {
+  public:
+    ShaderProgram();
+    // `program` is a linked program, e.g. pgl::Shader::id
+    explicit ShaderProgram(unsigned int program);
+
+    auto id() const -> unsigned int { return program; }
+    void use() const;
+    // location of an active uniform, -1 if there is none by that name;
+    // arrays are found by their bare name
+    auto location(const char* name) const -> int;
+
+    void set(int location, int value) const;
+    void set(int location, float value) const;
+    void set(int location, pgl::float2 value) const;
+    // points uniform block `name` at `binding`, if the program uses it
+    void bind_block(const char* name, unsigned int binding) const;
+
+  private:
+    unsigned int program;
+    std::vector<std::pair<std::string, int>> uniforms;
+};
+
+// Compiles and links a program from two GLSL source files; prints the
+// info log and returns 0 on failure.
+auto compile_program(const char* vertex_file, const char* fragment_file) -> unsigned int;
+// Same from the sources themselves, `name` labelling errors. A
+// `retrievable` program can be saved with glGetProgramBinary.
+auto compile_program(const std::string& vertex_source, const std::string& fragment_source,
+                     const char* name, bool retrievable = false) -> unsigned int;
+// Reads a whole source file; prints an error and returns false on failure.
+auto read_source(const char* file, std::string& source) -> bool;
+
+// Per-frame state shared by the game's shaders, in the std140 layout of
+// the `Frame` uniform block they declare.
+struct FrameData {
+  // column-major
+  std::array<float, 16> projection;
+  float time;
+  int   confuse, chaos, shake;
+};
+
+// Uniform block binding point of FrameData
+const unsigned int FRAME_BINDING = 0;
+
+// column-major orthographic projection for a y-down screen of that size
+auto ortho_projection(float width, float height) -> std::array<float, 16>;
+
+// UniformBuffer holds one FrameData on the GPU, bound at FRAME_BINDING.
+// update() uploads it once per frame for every program at once.
+class UniformBuffer {
+  public:
+    UniformBuffer();
+    ~UniformBuffer();
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    void update(const FrameData& data);
+
+  private:
+    unsigned int ubo;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <breakout/game.hpp>
+#include <breakout/stats.hpp>
+#include <breakout/triple-buffer.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+// Simulation runs Game::process_input and Game::update on a dedicated
+// thread at a fixed tick rate and publishes a WorldSnapshot after every
+// tick. The render thread picks up the latest snapshot with acquire(),
+// so a slow buffer swap or GPU stall never delays the physics.
+class Simulation {
+  public:
+    Simulation(Game& game, double tick_rate);
+    ~Simulation();
+
+    void start();
+    void stop();
+
+    // render side: latest published world, owned by the caller until the
+    // next call
+    auto acquire() -> WorldSnapshot&;
+    auto period() const -> double { return tick_period; }
+
+    // scheduling statistics, only meaningful once stop() returned
+    auto jitter() const -> const RunningStats& { return tick_jitter; }
+    auto skipped_ticks() const -> std::uint64_t { return skipped; }
+
+  private:
+    void run();
+
+    Game& game;
+    double tick_period;
+    TripleBuffer<WorldSnapshot> snapshots;
+    std::thread thread;
+    std::atomic<bool> running;
+    // lateness of each tick relative to its schedule (s)
+    RunningStats tick_jitter;
+    std::uint64_t skipped;
+};
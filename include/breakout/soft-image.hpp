@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Black at full alpha, the colour of a cleared image
+const std::uint32_t OPAQUE_BLACK = 0xFF000000u;
+// Alpha byte of a pixel
+const std::uint32_t ALPHA_MASK   = 0xFF000000u;
+
+// 8-bit RGBA image in memory order R, G, B, A, with row 0 at the top.
+struct SoftImage {
+  int  width  = 0;
+  int  height = 0;
+  // every alpha is 255, which lets blits skip blending
+  bool opaque = true;
+  std::vector<std::uint32_t> pixels;
+
+  void resize(int width, int height);
+  auto row(int y) -> std::uint32_t* { return pixels.data() + y * width; }
+  auto row(int y) const -> const std::uint32_t* { return pixels.data() + y * width; }
+};
+
+auto load_soft_image(const char* file, SoftImage& image) -> bool;
+// binary PPM (P6), alpha dropped
+auto write_ppm(const char* file, const SoftImage& image) -> bool;
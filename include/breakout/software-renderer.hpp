@@ -0,0 +1,124 @@
+#pragma once
+
+#include <breakout/game.hpp>
+#include <breakout/particle-system.hpp>
+#include <breakout/soft-image.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// RowPool runs a job over [0, rows) split in contiguous bands, one per
+// worker thread plus the calling thread, and returns once all bands are
+// done. Jobs are plain function pointers so dispatch never allocates.
+class RowPool {
+  public:
+    using Job = void (*)(void* context, int begin, int end);
+
+    explicit RowPool(unsigned int threads);
+    ~RowPool();
+
+    void run(int rows, Job job, void* context);
+    auto size() const -> unsigned int { return workers.size() + 1; }
+
+  private:
+    void work(unsigned int index);
+    void band(unsigned int index);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    Job   job;
+    void* context;
+    int   rows;
+    unsigned int generation, pending;
+    bool  quit;
+};
+
+// SoftwareRenderer draws a WorldSnapshot entirely on the CPU, as
+// Game::render would: textured, tinted and alpha-blended sprites and
+// additive particles into a scene image, then the confuse/chaos/shake
+// effects of postprocessor.vs/.fs into the frame, then the text. The two
+// first passes are split in row bands across a RowPool. It needs no GL
+// context, so frames of the game can be produced on machines without a
+// GPU; see capture --software.
+class SoftwareRenderer {
+  public:
+    SoftwareRenderer(int width, int height, unsigned int threads);
+
+    // loads the sprite textures from `directory` (resources/textures)
+    auto load_textures(const char* directory) -> bool;
+    // rasterizes ASCII at `size` pixels, like pgl::ui::TextRenderer::load;
+    // without a font, no text is drawn
+    auto load_font(const char* file, unsigned int size) -> bool;
+
+    // once per frame before render(), like the start of Game::render: a
+    // burst for every broken brick in `events`, then the ball's trail
+    void update_particles(SpscQueue<GameEvent, 256>& events, const WorldSnapshot& world,
+                          float alpha, float dt);
+    void render(const WorldSnapshot& world, float alpha, float time, SoftImage& frame);
+
+    // the two passes of render(), exposed for benchmarking
+    void draw_scene(const WorldSnapshot& world, float alpha);
+    void post_process(const EffectState& effects, float time, SoftImage& frame);
+    void draw_text(const WorldSnapshot& world, SoftImage& frame);
+
+    auto scene_image() const -> const SoftImage& { return scene; }
+
+  private:
+    enum Sprite {
+      SPRITE_BACKGROUND,
+      SPRITE_BLOCK,
+      SPRITE_BLOCK_SOLID,
+      SPRITE_PADDLE,
+      SPRITE_FACE,
+      SPRITE_PARTICLE,
+      SPRITE_POWERUP, // + PowerUpType
+      SPRITES = SPRITE_POWERUP + POWERUP_TYPES
+    };
+
+    struct Quad {
+      const SoftImage* texture;
+      float x, y, w, h;
+      pgl::float3 tint;
+      // particles: tinted by more than 1, faded and added to the scene
+      float alpha    = 1.0f;
+      bool  additive = false;
+    };
+
+    // coverage in alpha over white, placed like pangolin's glyphs
+    struct Glyph {
+      SoftImage image;
+      int bearing_x = 0, bearing_y = 0;
+      int advance   = 0;
+    };
+
+    struct PostParameters {
+      int  mode;
+      int  quad_x, quad_y;     // shake displacement of the whole frame
+      int  shift_x, shift_y;   // chaos texture coordinate scroll
+      int  kernel_x, kernel_y; // 3x3 kernel sample spacing
+      bool mirror;             // confuse flips both axes
+    };
+
+    static void scene_band(void* context, int begin, int end);
+    static void post_band(void* context, int begin, int end);
+    void post_row(const PostParameters& parameters, std::uint32_t* out, int y) const;
+
+    int width, height;
+    RowPool pool;
+    std::array<SoftImage, SPRITES> textures;
+    std::array<Glyph, 128> glyphs;
+    ParticlePool particles;
+    std::vector<Quad> quads;
+    // "Lives:N", kept to format in place
+    std::string lives;
+    SoftImage scene;
+    // state of the pass being dispatched to the pool
+    SoftImage*     target;
+    PostParameters post;
+};
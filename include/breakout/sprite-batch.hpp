@@ -0,0 +1,62 @@
+#pragma once
+
+#include <breakout/texture-atlas.hpp>
+#include <breakout/shader-program.hpp>
+
+#include <pangolin/shader.hpp>
+#include <pgl-math/vector.hpp>
+
+#include <cstddef>
+#include <vector>
+
+// Counters since the last SpriteBatch::begin().
+struct BatchStats {
+  unsigned int binds   = 0;
+  unsigned int draws   = 0;
+  unsigned int sprites = 0;
+};
+
+// SpriteBatch draws atlas regions as untransformed (unrotated) quads.
+// Each sprite is one instance (rectangle, texture coordinates, color) of
+// a shared unit quad; instances are appended to a CPU array and sent with
+// one instanced draw per run of sprites sharing an atlas page, so a frame
+// of bricks, paddle, ball and power-ups costs one bind and one draw
+// instead of one of each per sprite. Uses shaders/batch.vs/.fs.
+class SpriteBatch {
+  public:
+    SpriteBatch(pgl::Shader shader, const TextureAtlas& atlas, std::size_t capacity);
+    ~SpriteBatch();
+    SpriteBatch(const SpriteBatch&) = delete;
+    SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+    void begin();
+    void draw(unsigned int region, pgl::float2 position, pgl::float2 size,
+              pgl::float3 color = pgl::float3(1.0f));
+    // sends the pending quads; call before drawing anything else
+    void flush();
+    // forgets the page bound to unit 0; call after anything else drew
+    // between two flushes, e.g. the particles
+    void invalidate();
+
+    auto stats() const -> const BatchStats& { return counters; }
+    // switches to another linked build of batch.vs/.fs, e.g. after a reload
+    void set_program(unsigned int program);
+
+  private:
+    void configure_program();
+
+    struct Instance {
+      float x, y, w, h;
+      float u0, v0, u1, v1;
+      float r, g, b;
+    };
+
+    ShaderProgram shader;
+    const TextureAtlas& atlas;
+    std::size_t capacity;
+    std::vector<Instance> instances;
+    unsigned int vao, quad_vbo, instance_vbo;
+    // page of the pending quads and page currently bound to unit 0
+    unsigned int page, bound;
+    BatchStats counters;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// SpscQueue is a bounded single-producer/single-consumer ring buffer.
+// Neither side blocks or allocates; if the queue is full the newest
+// value is dropped and counted.
+template<typename T, std::size_t N>
+class SpscQueue {
+  public:
+    static constexpr std::size_t capacity = N;
+    static_assert((N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    SpscQueue()
+      : values(), head(0), tail(0), overflow(0) { }
+
+    // producer side
+    bool push(const T& value) {
+      std::size_t t = tail.load(std::memory_order_relaxed);
+      if (t - head.load(std::memory_order_acquire) == capacity) {
+        overflow.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      values[t & (capacity - 1)] = value;
+      tail.store(t + 1, std::memory_order_release);
+      return true;
+    }
+
+    // consumer side
+    bool peek(T& value) const {
+      std::size_t h = head.load(std::memory_order_relaxed);
+      if (h == tail.load(std::memory_order_acquire))
+        return false;
+      value = values[h & (capacity - 1)];
+      return true;
+    }
+
+    bool pop(T& value) {
+      if (!peek(value))
+        return false;
+      head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+      return true;
+    }
+
+    auto dropped() const -> std::size_t {
+      return overflow.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::array<T, N> values;
+    alignas(64) std::atomic<std::size_t> head; // next slot to read
+    alignas(64) std::atomic<std::size_t> tail; // next slot to write
+    std::atomic<std::size_t> overflow;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// RunningStats accumulates count, mean, variance and extrema of a
+// stream of samples in constant space (Welford's algorithm).
+class RunningStats {
+  public:
+    RunningStats();
+
+    void add(double sample);
+    void clear();
+
+    auto count()    const -> std::size_t { return n; }
+    auto mean()     const -> double { return n > 0 ? m : 0.0; }
+    auto min()      const -> double { return n > 0 ? lo : 0.0; }
+    auto max()      const -> double { return n > 0 ? hi : 0.0; }
+    auto variance() const -> double;
+    auto stddev()   const -> double;
+
+  private:
+    std::size_t n;
+    double m, s;
+    double lo, hi;
+};
+
+// FNV-1a: the hash of no bytes, and folding bytes into a hash
+const std::uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325ull;
+inline void hash_bytes(std::uint64_t& hash, const void* data, std::size_t size) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001B3ull;
+  }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <breakout/soft-image.hpp>
+
+#include <string>
+#include <vector>
+
+// A sprite's place in the atlas: its page and texture coordinates (v
+// grows downward, matching how images are uploaded).
+struct AtlasRegion {
+  unsigned int page = 0;
+  float u0 = 0.0f, v0 = 0.0f;
+  float u1 = 0.0f, v1 = 0.0f;
+};
+
+// TextureAtlas packs a set of images into as few square pages as
+// possible (shelf packing, tallest first) at load time. Each image is
+// surrounded by a copy of its own border so that linear filtering never
+// samples a neighbour. Pages live on the CPU until upload() creates one
+// GL texture per page.
+class TextureAtlas {
+  public:
+    explicit TextureAtlas(int page_size = 2048, int padding = 2);
+
+    // returns the id to look the region up with once packed
+    auto add(const std::string& name, SoftImage image) -> unsigned int;
+    // like ResourceManager::load_texture, `alpha` false drops the alpha channel
+    auto add(const std::string& name, const char* file, bool alpha) -> unsigned int;
+    void pack();
+    void upload();
+
+    auto region(unsigned int id) const -> const AtlasRegion& { return regions[id]; }
+    auto page_count() const -> unsigned int { return pages.size(); }
+    auto page_texture(unsigned int page) const -> unsigned int { return textures[page]; }
+    auto page_image(unsigned int page) const -> const SoftImage& { return pages[page]; }
+
+  private:
+    void blit(SoftImage& page, const SoftImage& image, int x, int y);
+
+    int page_size, padding;
+    std::vector<std::string>  names;
+    std::vector<SoftImage>    images;
+    std::vector<AtlasRegion>  regions;
+    std::vector<SoftImage>    pages;
+    std::vector<unsigned int> textures;
+};
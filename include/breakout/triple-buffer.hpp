@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// TripleBuffer hands whole values from one producer thread to one
+// consumer thread without locks. The producer always has a private slot
+// to write into, the consumer always has a private slot to read from,
+// and the third slot holds the most recently published value. Neither
+// side ever waits for the other; intermediate values the consumer did
+// not pick up in time are simply overwritten.
+template<typename T>
+class TripleBuffer {
+  public:
+    TripleBuffer()
+      : buffers(), back(0), middle(1), front(2) { }
+
+    // producer: slot to fill before calling publish()
+    T& write_buffer() { return buffers[back]; }
+
+    // producer: makes the write buffer the latest value
+    void publish() {
+      back = middle.exchange(back | fresh, std::memory_order_acq_rel) & index;
+    }
+
+    // consumer: swaps in the latest value if one was published since the
+    // last call; returns whether the read buffer changed
+    bool update() {
+      if (!(middle.load(std::memory_order_relaxed) & fresh))
+        return false;
+      front = middle.exchange(front, std::memory_order_acq_rel) & index;
+      return true;
+    }
+
+    // consumer: slot owned by the reader until the next update()
+    T& read_buffer() { return buffers[front]; }
+
+  private:
+    static constexpr unsigned int index = 0x3;
+    static constexpr unsigned int fresh = 0x4;
+
+    std::array<T, 3> buffers;
+    unsigned int back;
+    std::atomic<unsigned int> middle;
+    unsigned int front;
+};
@@ -0,0 +1,22 @@
+#version 330 core
+layout (location = 0) in vec2 corner; // unit quad, (0, 0) is the top left
+layout (location = 1) in vec4 rect;   // per sprite: <vec2 position, vec2 size>
+layout (location = 2) in vec4 uv;     // per sprite: <vec2 top left, vec2 bottom right>
+layout (location = 3) in vec3 color;  // per sprite
+
+out vec2 TexCoords;
+out vec3 SpriteColor;
+
+layout (std140) uniform Frame {
+  mat4  projection;
+  float time;
+  bool  confuse;
+  bool  chaos;
+  bool  shake;
+};
+
+void main() {
+  TexCoords = mix(uv.xy, uv.zw, corner);
+  SpriteColor = color;
+  gl_Position = projection * vec4(rect.xy + corner * rect.zw, 0.0, 1.0);
+}
@@ -7,9 +7,13 @@ uniform vec2      offsets[9];
 uniform int       edge_kernel[9];
 uniform float     blur_kernel[9];
 
-uniform bool chaos;
-uniform bool confuse;
-uniform bool shake;
+layout (std140) uniform Frame {
+  mat4  projection;
+  float time;
+  bool  confuse;
+  bool  chaos;
+  bool  shake;
+};
 
 void main() {
   color = vec4(0.0, 0.0, 0.0, 1.0);
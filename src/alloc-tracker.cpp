@@ -0,0 +1,140 @@
+#include <breakout/alloc-tracker.hpp>
+
+#ifdef BREAKOUT_TRACK_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+// Phases live in a fixed table so that tracking itself never allocates.
+const int MAX_PHASES = 32;
+
+struct PhaseCounters {
+  const char* name;
+  std::atomic<std::size_t> count;
+  std::atomic<std::size_t> bytes;
+};
+
+static PhaseCounters phases[MAX_PHASES] = { { "other", {0}, {0} } };
+static std::atomic<int> phase_count{1};
+static std::mutex registration;
+
+thread_local int current_phase = 0;
+
+static auto find_phase(const char* name) -> int {
+  int n = phase_count.load(std::memory_order_acquire);
+  for (int i = 0; i < n; ++i)
+    if (phases[i].name == name || std::strcmp(phases[i].name, name) == 0)
+      return i;
+  return -1;
+}
+
+static auto register_phase(const char* name) -> int {
+  int index = find_phase(name);
+  if (index >= 0)
+    return index;
+
+  std::lock_guard<std::mutex> lock(registration);
+  if ((index = find_phase(name)) >= 0)
+    return index;
+  index = phase_count.load(std::memory_order_relaxed);
+  if (index == MAX_PHASES)
+    return 0;
+  phases[index].name = name;
+  phase_count.store(index + 1, std::memory_order_release);
+  return index;
+}
+
+static void record(std::size_t size) {
+  PhaseCounters& phase = phases[current_phase];
+  phase.count.fetch_add(1, std::memory_order_relaxed);
+  phase.bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+AllocationScope::AllocationScope(const char* phase)
+  : previous(current_phase)
+{
+  current_phase = register_phase(phase);
+}
+
+AllocationScope::~AllocationScope() {
+  current_phase = previous;
+}
+
+auto allocation_counts(const char* phase) -> AllocationCounts {
+  int index = find_phase(phase);
+  if (index < 0)
+    return {};
+  return {
+    phases[index].count.load(std::memory_order_relaxed),
+    phases[index].bytes.load(std::memory_order_relaxed)
+  };
+}
+
+void report_allocations(std::ostream& out) {
+  int n = phase_count.load(std::memory_order_acquire);
+  for (int i = 0; i < n; ++i) {
+    std::size_t count = phases[i].count.load(std::memory_order_relaxed);
+    if (count > 0)
+      out << "allocations[" << phases[i].name << "]: " << count << " ("
+          << phases[i].bytes.load(std::memory_order_relaxed) << " bytes)\n";
+  }
+}
+
+// global allocation hooks
+// -----------------------
+
+void* operator new(std::size_t size) {
+  record(size);
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  record(size);
+  return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return operator new(size, std::nothrow);
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+  record(size);
+  std::size_t alignment = static_cast<std::size_t>(align);
+  if (void* p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment))
+    return p;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+  return operator new(size, align);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+#else
+
+auto allocation_counts(const char*) -> AllocationCounts {
+  return {};
+}
+
+void report_allocations(std::ostream&) {
+
+}
+
+#endif
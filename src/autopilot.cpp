@@ -0,0 +1,307 @@
+#include <breakout/autopilot.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+// Reflections traced before giving up on a query
+const unsigned int MAX_BOUNCES = 16;
+// Fraction of the paddle half-width off-centre the ball is aimed at
+const float AIM_OFFSET = 0.4f;
+
+auto predict_landing(
+  pgl::float2 position, pgl::float2 velocity, float radius, bool pass_through,
+  const std::vector<pgl::GameObject>& bricks,
+  float window_width, float paddle_line) -> Prediction
+{
+  const float inf = std::numeric_limits<float>::infinity();
+  // breakable bricks are destroyed by the first contact, so a path must
+  // not bounce off them twice
+  std::array<const pgl::GameObject*, MAX_BOUNCES> broken{};
+  unsigned int broken_count = 0;
+
+  float elapsed = 0.0f;
+  for (unsigned int bounce = 0; bounce <= MAX_BOUNCES; ++bounce) {
+    if (velocity.x == 0.0f && velocity.y == 0.0f)
+      break;
+
+    // the paddle line ends the query
+    if (velocity.y > 0.0f && position.y >= paddle_line)
+      return {true, position.x, elapsed, bounce};
+
+    float t_hit = inf;
+    bool  flip_x = false;
+    const pgl::GameObject* hit = nullptr;
+
+    // side walls, top wall and paddle line
+    if (velocity.x < 0.0f) {
+      t_hit  = position.x / -velocity.x;
+      flip_x = true;
+    } else if (velocity.x > 0.0f) {
+      t_hit  = (window_width - 2.0f * radius - position.x) / velocity.x;
+      flip_x = true;
+    }
+
+    float t_y = inf;
+    if (velocity.y < 0.0f)
+      t_y = position.y / -velocity.y;
+    else if (velocity.y > 0.0f)
+      t_y = (paddle_line - position.y) / velocity.y;
+    if (t_y < t_hit) {
+      t_hit  = t_y;
+      flip_x = false;
+    }
+
+    // bricks, as slabs of the brick grown by the ball's radius around the
+    // ball's centre
+    pgl::float2 center = position + radius;
+    for (const pgl::GameObject& brick : bricks) {
+      if (brick.destroyed || (pass_through && !brick.is_solid))
+        continue;
+      bool skip = false;
+      for (unsigned int i = 0; i < broken_count; ++i)
+        skip |= (broken[i] == &brick);
+      if (skip)
+        continue;
+
+      float lo_x = brick.position.x - radius, hi_x = brick.position.x + brick.size.x + radius;
+      float lo_y = brick.position.y - radius, hi_y = brick.position.y + brick.size.y + radius;
+
+      float tx0 = -inf, tx1 = inf, ty0 = -inf, ty1 = inf;
+      if (velocity.x != 0.0f) {
+        tx0 = (lo_x - center.x) / velocity.x;
+        tx1 = (hi_x - center.x) / velocity.x;
+        if (tx0 > tx1) std::swap(tx0, tx1);
+      } else if (center.x < lo_x || center.x > hi_x) {
+        continue;
+      }
+      if (velocity.y != 0.0f) {
+        ty0 = (lo_y - center.y) / velocity.y;
+        ty1 = (hi_y - center.y) / velocity.y;
+        if (ty0 > ty1) std::swap(ty0, ty1);
+      } else if (center.y < lo_y || center.y > hi_y) {
+        continue;
+      }
+
+      float enter = std::max(tx0, ty0);
+      float exit  = std::min(tx1, ty1);
+      // ignore bricks behind us or already overlapping the ball
+      if (enter < 0.0f || enter > exit || enter >= t_hit)
+        continue;
+      t_hit  = enter;
+      flip_x = tx0 > ty0;
+      hit    = &brick;
+    }
+
+    if (t_hit == inf)
+      break;
+
+    position += velocity * t_hit;
+    elapsed  += t_hit;
+    if (!hit && velocity.y > 0.0f && position.y >= paddle_line - 1e-3f)
+      return {true, position.x, elapsed, bounce};
+
+    if (flip_x)
+      velocity.x = -velocity.x;
+    else
+      velocity.y = -velocity.y;
+    if (hit && !hit->is_solid && broken_count < broken.size())
+      broken[broken_count++] = hit;
+  }
+  return {false, position.x, elapsed, MAX_BOUNCES};
+}
+
+// Fixed division that saturates instead of overflowing, for times to
+// reach a far plane at a crawl
+static auto divide(Fixed distance, Fixed speed) -> Fixed {
+  std::int64_t quotient = static_cast<std::int64_t>(distance.value()) * Fixed::one / speed.value();
+  return Fixed::from_raw(static_cast<std::int32_t>(
+    std::clamp<std::int64_t>(quotient, -INT32_MAX, INT32_MAX)));
+}
+
+auto predict_landing_fixed(
+  Fixed2 position, Fixed2 velocity, Fixed radius, bool pass_through,
+  const std::vector<pgl::GameObject>& bricks,
+  Fixed window_width, Fixed paddle_line) -> FixedPrediction
+{
+  const Fixed inf = Fixed::from_raw(INT32_MAX);
+  const Fixed zero;
+  std::array<const pgl::GameObject*, MAX_BOUNCES> broken{};
+  unsigned int broken_count = 0;
+
+  Fixed elapsed;
+  for (unsigned int bounce = 0; bounce <= MAX_BOUNCES; ++bounce) {
+    if (velocity.x == zero && velocity.y == zero)
+      break;
+
+    if (velocity.y > zero && position.y >= paddle_line)
+      return {true, position.x, elapsed, bounce};
+
+    Fixed t_hit = inf;
+    bool  flip_x = false;
+    const pgl::GameObject* hit = nullptr;
+
+    if (velocity.x < zero) {
+      t_hit  = divide(position.x, -velocity.x);
+      flip_x = true;
+    } else if (velocity.x > zero) {
+      t_hit  = divide(window_width - radius * 2 - position.x, velocity.x);
+      flip_x = true;
+    }
+
+    Fixed t_y = inf;
+    if (velocity.y < zero)
+      t_y = divide(position.y, -velocity.y);
+    else if (velocity.y > zero)
+      t_y = divide(paddle_line - position.y, velocity.y);
+    if (t_y < t_hit) {
+      t_hit  = t_y;
+      flip_x = false;
+    }
+
+    Fixed2 center = position + Fixed2{radius, radius};
+    for (const pgl::GameObject& brick : bricks) {
+      if (brick.destroyed || (pass_through && !brick.is_solid))
+        continue;
+      bool skip = false;
+      for (unsigned int i = 0; i < broken_count; ++i)
+        skip |= (broken[i] == &brick);
+      if (skip)
+        continue;
+
+      Fixed2 low  = Fixed2::from_float(brick.position);
+      Fixed2 high = low + Fixed2::from_float(brick.size);
+      Fixed lo_x = low.x - radius, hi_x = high.x + radius;
+      Fixed lo_y = low.y - radius, hi_y = high.y + radius;
+
+      Fixed tx0 = -inf, tx1 = inf, ty0 = -inf, ty1 = inf;
+      if (velocity.x != zero) {
+        tx0 = divide(lo_x - center.x, velocity.x);
+        tx1 = divide(hi_x - center.x, velocity.x);
+        if (tx0 > tx1) std::swap(tx0, tx1);
+      } else if (center.x < lo_x || center.x > hi_x) {
+        continue;
+      }
+      if (velocity.y != zero) {
+        ty0 = divide(lo_y - center.y, velocity.y);
+        ty1 = divide(hi_y - center.y, velocity.y);
+        if (ty0 > ty1) std::swap(ty0, ty1);
+      } else if (center.y < lo_y || center.y > hi_y) {
+        continue;
+      }
+
+      Fixed enter = std::max(tx0, ty0);
+      Fixed exit  = std::min(tx1, ty1);
+      if (enter < zero || enter > exit || enter >= t_hit)
+        continue;
+      t_hit  = enter;
+      flip_x = tx0 > ty0;
+      hit    = &brick;
+    }
+
+    if (t_hit == inf)
+      break;
+
+    position = position + Fixed2{velocity.x * t_hit, velocity.y * t_hit};
+    elapsed += t_hit;
+    // the times are truncated, so the segment may stop just short of the
+    // paddle line: ending on it is enough
+    if (!hit && !flip_x && velocity.y > zero)
+      return {true, position.x, elapsed, bounce};
+
+    if (flip_x)
+      velocity.x = -velocity.x;
+    else
+      velocity.y = -velocity.y;
+    if (hit && !hit->is_solid && broken_count < broken.size())
+      broken[broken_count++] = hit;
+  }
+  return {false, position.x, elapsed, MAX_BOUNCES};
+}
+
+Autopilot::Autopilot()
+  : prediction{false, 0.0f, 0.0f, 0}, paddle_target(0.0f), paddle_fixed_target(), timing()
+{
+
+}
+
+void Autopilot::plan(
+  const pgl::GameObject& player, const BallObject& ball,
+  const std::vector<pgl::GameObject>& bricks,
+  float window_width, bool fixed_point)
+{
+  auto start = std::chrono::steady_clock::now();
+  if (fixed_point) {
+    plan_fixed(player, ball, bricks, window_width);
+    timing.add(std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count());
+    return;
+  }
+
+  float half_width = player.size.x / 2.0f;
+  float ball_center = ball.position.x + ball.radius;
+  if (ball.stuck) {
+    paddle_target = player.position.x + half_width;
+    prediction = {false, ball.position.x, 0.0f, 0};
+  } else {
+    prediction = predict_landing(
+      ball.position, ball.velocity, ball.radius, ball.pass_through, bricks,
+      window_width, player.position.y - 2.0f * ball.radius);
+    float landing = prediction.valid ? prediction.x + ball.radius : ball_center;
+
+    // hit the ball off-centre so that it leaves toward the bricks still
+    // standing
+    float sum = 0.0f;
+    unsigned int live = 0;
+    for (const pgl::GameObject& brick : bricks) {
+      if (!brick.destroyed && !brick.is_solid) {
+        sum += brick.position.x + brick.size.x / 2.0f;
+        ++live;
+      }
+    }
+    float aim = live > 0 ? sum / live : window_width / 2.0f;
+    float side = aim > landing ? 1.0f : -1.0f;
+    paddle_target = landing - side * AIM_OFFSET * half_width;
+  }
+
+  timing.add(std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count());
+}
+
+void Autopilot::plan_fixed(
+  const pgl::GameObject& player, const BallObject& ball,
+  const std::vector<pgl::GameObject>& bricks,
+  float window_width)
+{
+  Fixed half_width = Fixed::from_float(player.size.x) / 2;
+  Fixed radius     = Fixed::from_float(ball.radius);
+  Fixed2 position  = Fixed2::from_float(ball.position);
+  if (ball.stuck) {
+    paddle_fixed_target = Fixed::from_float(player.position.x) + half_width;
+    prediction = {false, ball.position.x, 0.0f, 0};
+  } else {
+    FixedPrediction landed = predict_landing_fixed(
+      position, Fixed2::from_float(ball.velocity), radius, ball.pass_through, bricks,
+      Fixed::from_float(window_width), Fixed::from_float(player.position.y) - radius * 2);
+    prediction = {landed.valid, landed.x.to_float(), landed.time.to_float(), landed.bounces};
+    Fixed landing = (landed.valid ? landed.x : position.x) + radius;
+
+    // brick centres add up past Q16.16's range: sum the raw values wide
+    std::int64_t sum = 0;
+    unsigned int live = 0;
+    for (const pgl::GameObject& brick : bricks) {
+      if (!brick.destroyed && !brick.is_solid) {
+        sum += (Fixed::from_float(brick.position.x) + Fixed::from_float(brick.size.x) / 2).value();
+        ++live;
+      }
+    }
+    Fixed aim = live > 0 ? Fixed::from_raw(static_cast<std::int32_t>(sum / live))
+                         : Fixed::from_float(window_width) / 2;
+    Fixed offset = Fixed::from_float(AIM_OFFSET) * half_width;
+    paddle_fixed_target = aim > landing ? landing - offset : landing + offset;
+  }
+  paddle_target = paddle_fixed_target.to_float();
+}
@@ -6,10 +6,9 @@ BallObject::BallObject()
 
 BallObject::BallObject(
   pgl::float2 pos, float radius,
-  pgl::float2 velocity,
-  pgl::Texture2D sprite)
+  pgl::float2 velocity)
   : GameObject(pos, pgl::float2(radius * 2.0f, radius * 2.0f),
-               sprite, pgl::float3(1.0f), velocity),
+               pgl::Texture2D(), pgl::float3(1.0f), velocity),
   radius(radius),
   sticky(false),
   pass_through(false),
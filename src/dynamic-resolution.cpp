@@ -0,0 +1,78 @@
+#include <breakout/dynamic-resolution.hpp>
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Weight of the newest frame in the smoothed GPU time
+const double SMOOTHING = 0.1;
+// Frames measured at a scale before it may change again
+const unsigned int SETTLE_FRAMES = 30;
+// Fraction of the budget a new scale aims for
+const double TARGET_LOAD = 0.85;
+// Below this fraction of the budget the scale is allowed back up
+const double RAISE_LOAD = 0.7;
+// Scales are multiples of this, which bounds how often targets reallocate
+const float SCALE_STEP = 0.05f;
+
+GpuTimer::GpuTimer() : queries(), issued(0), collected(0) {
+  glGenQueries(QUERIES, queries.data());
+}
+
+GpuTimer::~GpuTimer() {
+  glDeleteQueries(QUERIES, queries.data());
+}
+
+void GpuTimer::begin() {
+  // every query still in flight: drop the oldest rather than wait for it
+  if (issued - collected == QUERIES)
+    ++collected;
+  glBeginQuery(GL_TIME_ELAPSED, queries[issued % QUERIES]);
+}
+
+void GpuTimer::end() {
+  glEndQuery(GL_TIME_ELAPSED);
+  ++issued;
+}
+
+auto GpuTimer::poll() -> double {
+  if (collected == issued)
+    return -1.0;
+  unsigned int query = queries[collected % QUERIES];
+  GLint available = 0;
+  glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available)
+    return -1.0;
+  GLuint64 elapsed = 0;
+  glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+  ++collected;
+  return elapsed * 1e-9;
+}
+
+ResolutionController::ResolutionController(double budget, float min_scale, float max_scale)
+  : budget(budget), low(min_scale), high(max_scale), current(max_scale),
+    smoothed(0.0), samples(0)
+{
+
+}
+
+auto ResolutionController::update(double gpu_time) -> float {
+  if (gpu_time <= 0.0)
+    return current;
+  smoothed = samples == 0 ? gpu_time : smoothed + SMOOTHING * (gpu_time - smoothed);
+  if (++samples < SETTLE_FRAMES)
+    return current;
+
+  double load = smoothed / budget;
+  if (load <= 1.0 && !(load < RAISE_LOAD && current < high))
+    return current;
+
+  float ideal = current * std::sqrt(TARGET_LOAD / load);
+  float next  = std::clamp(std::floor(ideal / SCALE_STEP + 1e-3f) * SCALE_STEP, low, high);
+  if (next != current) {
+    current = next;
+    samples = 0;
+  }
+  return current;
+}
@@ -0,0 +1,243 @@
+#include <breakout/endless-level.hpp>
+
+#include <algorithm>
+
+// Speed at which the brick field moves down the screen (pixels/s)
+const float SCROLL_SPEED = 12.0f;
+
+// splitmix64: small, fast and good enough to lay out bricks
+static auto next_random(std::uint64_t& state) -> std::uint64_t {
+  std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+ChunkGenerator::ChunkGenerator()
+  : pool(), free_chunks(), ready(),
+    free_count(pool_size), ready_head(0), ready_count(0),
+    seed(0), next_index(0), epoch(0), running(false),
+    mutex(), wake(), worker()
+{
+  for (unsigned int i = 0; i < pool_size; ++i)
+    free_chunks[i] = &pool[i];
+}
+
+ChunkGenerator::~ChunkGenerator() {
+  stop();
+}
+
+void ChunkGenerator::start(std::uint64_t seed, std::uint64_t first) {
+  bool spawn;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->seed = seed;
+    next_index = first;
+    // ready chunks of the previous run go back to the pool; one the worker
+    // is still generating is dropped when it comes back
+    ++epoch;
+    for (; ready_count > 0; --ready_count, ready_head = (ready_head + 1) % pool_size)
+      free_chunks[free_count++] = ready[ready_head];
+    spawn   = !running;
+    running = true;
+  }
+  if (spawn)
+    worker = std::thread(&ChunkGenerator::run, this);
+  else
+    wake.notify_one();
+}
+
+void ChunkGenerator::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running = false;
+  }
+  wake.notify_one();
+  if (worker.joinable())
+    worker.join();
+}
+
+auto ChunkGenerator::poll() -> TileChunk* {
+  std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+  if (!lock.owns_lock() || ready_count == 0)
+    return nullptr;
+  TileChunk* chunk = ready[ready_head];
+  ready_head = (ready_head + 1) % pool_size;
+  --ready_count;
+  return chunk;
+}
+
+void ChunkGenerator::recycle(TileChunk* chunk) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    free_chunks[free_count++] = chunk;
+  }
+  wake.notify_one();
+}
+
+void ChunkGenerator::run() {
+  for (;;) {
+    TileChunk* chunk;
+    std::uint64_t chunk_seed;
+    unsigned int chunk_epoch;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [this] { return !running || free_count > 0; });
+      if (!running)
+        return;
+      chunk = free_chunks[--free_count];
+      chunk->index = next_index++;
+      chunk_seed  = seed;
+      chunk_epoch = epoch;
+    }
+    generate(chunk_seed, *chunk);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (chunk_epoch == epoch) {
+        ready[(ready_head + ready_count) % pool_size] = chunk;
+        ++ready_count;
+      } else {
+        free_chunks[free_count++] = chunk;
+      }
+    }
+  }
+}
+
+void ChunkGenerator::generate(std::uint64_t seed, TileChunk& chunk) {
+  std::uint64_t state = seed ^ (chunk.index * 0xD1B54A32D192ED03ull);
+  // fields get denser and more obstructed the further the run goes
+  unsigned int depth = std::min<std::uint64_t>(chunk.index, 20);
+  unsigned int empty = 40 - depth;
+  unsigned int solid = 2 + depth / 4;
+
+  const unsigned int columns = TileChunk::columns;
+  for (unsigned int y = 0; y < TileChunk::rows; ++y) {
+    unsigned char colour = 2 + next_random(state) % 4;
+    // rows are mirrored around the centre, like the hand-made levels
+    for (unsigned int x = 0; x < (columns + 1) / 2; ++x) {
+      unsigned int roll = next_random(state) % 100;
+      unsigned char code;
+      if (roll < empty)
+        code = 0;
+      else if (roll < empty + solid)
+        code = 1;
+      else
+        code = (roll & 1) ? colour : 2 + (colour - 1) % 4;
+      chunk.tiles[y * columns + x] = code;
+      chunk.tiles[y * columns + columns - 1 - x] = code;
+    }
+  }
+}
+
+EndlessLevel::EndlessLevel()
+  : bricks(), colliders(), generator(), seed(0), streaming(false), chunk_top(), occupied(),
+    unit_width(0.0f), unit_height(0.0f), view_height(0.0f), scrolled(0.0f)
+{
+
+}
+
+void EndlessLevel::init(
+  unsigned int level_width,
+  unsigned int level_height,
+  std::uint64_t seed)
+{
+  // one chunk has the footprint of a hand-made level
+  unit_width  = level_width / static_cast<float>(TileChunk::columns);
+  unit_height = level_height / static_cast<float>(TileChunk::rows);
+  view_height = 2.0f * level_height;
+  scrolled    = 0.0f;
+  this->seed  = seed;
+  streaming   = false;
+
+  bricks.assign(resident_chunks * TileChunk::rows * TileChunk::columns, pgl::GameObject());
+
+  // the initial field is built synchronously; everything after streams
+  // in from the generator thread, which a game that never plays this
+  // level doesn't need
+  float chunk_height = TileChunk::rows * unit_height;
+  TileChunk chunk;
+  for (unsigned int slot = 0; slot < resident_chunks; ++slot) {
+    chunk.index = slot;
+    ChunkGenerator::generate(seed, chunk);
+    install(slot, chunk, -chunk_height * slot);
+  }
+}
+
+void EndlessLevel::update(float dt) {
+  if (!streaming) {
+    generator.start(seed, resident_chunks);
+    streaming = true;
+  }
+
+  float offset = SCROLL_SPEED * dt;
+  scrolled += offset;
+
+  const unsigned int per_chunk = TileChunk::rows * TileChunk::columns;
+  float top = 0.0f;
+  for (unsigned int slot = 0; slot < resident_chunks; ++slot) {
+    if (!occupied[slot])
+      continue;
+    chunk_top[slot] += offset;
+    for (unsigned int i = slot * per_chunk; i < (slot + 1) * per_chunk; ++i)
+      bricks[i].position.y += offset;
+
+    // retire chunks that scrolled past the bottom of the screen
+    if (chunk_top[slot] >= view_height) {
+      occupied[slot] = false;
+      for (unsigned int i = slot * per_chunk; i < (slot + 1) * per_chunk; ++i)
+        bricks[i].destroyed = true;
+    } else {
+      top = std::min(top, chunk_top[slot]);
+    }
+  }
+
+  // refill free slots above the topmost chunk with whatever is ready
+  float chunk_height = TileChunk::rows * unit_height;
+  for (unsigned int slot = 0; slot < resident_chunks; ++slot) {
+    if (occupied[slot])
+      continue;
+    TileChunk* chunk = generator.poll();
+    if (!chunk)
+      break;
+    top -= chunk_height;
+    install(slot, *chunk, top);
+    generator.recycle(chunk);
+  }
+}
+
+void EndlessLevel::install(unsigned int slot, const TileChunk& chunk, float top) {
+  const unsigned int per_chunk = TileChunk::rows * TileChunk::columns;
+  pgl::GameObject* brick = &bricks[slot * per_chunk];
+  pgl::float2 size(unit_width, unit_height);
+  // bricks are drawn from the atlas and carry no texture of their own
+  pgl::Texture2D no_texture;
+
+  for (unsigned int y = 0; y < TileChunk::rows; ++y) {
+    for (unsigned int x = 0; x < TileChunk::columns; ++x, ++brick) {
+      unsigned char code = chunk.tiles[y * TileChunk::columns + x];
+      pgl::float2 pos(unit_width * x, top + unit_height * y);
+      if (code == 1) {
+        *brick = pgl::GameObject(
+          pos, size,
+          no_texture,
+          pgl::float3(0.8f, 0.8f, 0.7f));
+        brick->is_solid = true;
+      } else {
+        pgl::float3 color = pgl::float3(1.0f);
+        if (code == 2)
+          color = pgl::float3(0.2f, 0.6f, 1.0f);
+        else if (code == 3)
+          color = pgl::float3(0.0f, 0.7f, 0.0f);
+        else if (code == 4)
+          color = pgl::float3(0.8f, 0.8f, 0.4f);
+        else if (code == 5)
+          color = pgl::float3(1.0f, 0.5f, 0.0f);
+        *brick = pgl::GameObject(
+          pos, size, no_texture, color);
+        brick->destroyed = (code == 0);
+      }
+    }
+  }
+  chunk_top[slot] = top;
+  occupied[slot]  = true;
+}
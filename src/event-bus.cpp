@@ -0,0 +1,34 @@
+#include <breakout/event-bus.hpp>
+
+EventBus::EventBus()
+  : events(), used(0), counts(), stats(), overflow(0)
+{
+
+}
+
+void EventBus::emit(const GameEvent& event) {
+  ++counts[event.type];
+  if (used == capacity) {
+    ++overflow;
+    return;
+  }
+  events[used++] = event;
+}
+
+void EventBus::end_tick() {
+  for (unsigned int type = 0; type < GAME_EVENT_TYPES; ++type) {
+    stats[type].add(counts[type]);
+    counts[type] = 0;
+  }
+  used = 0;
+}
+
+auto event_name(GameEventType type) -> const char* {
+  switch (type) {
+    case EVENT_BRICK_DESTROYED:   return "brick destroyed";
+    case EVENT_SOLID_HIT:         return "solid hit";
+    case EVENT_POWERUP_COLLECTED: return "power-up collected";
+    case EVENT_PADDLE_HIT:        return "paddle hit";
+    default:                      return "unknown";
+  }
+}
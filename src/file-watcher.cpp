@@ -0,0 +1,99 @@
+#include <breakout/file-watcher.hpp>
+
+#include <pangolin/glfw-support.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// How often the watcher thread checks whether it should stop (ms)
+const int STOP_POLL = 100;
+
+FileWatcher::FileWatcher()
+  : fd(-1), watches(), thread(), running(false), notify(nullptr)
+{
+#ifdef __linux__
+  fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0)
+    std::cout << "ERROR::FILEWATCHER: inotify unavailable: " << std::strerror(errno) << std::endl;
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+  stop();
+#ifdef __linux__
+  if (fd >= 0)
+    close(fd);
+#endif
+}
+
+auto FileWatcher::watch(const char* directory, FileChangeQueue& changes) -> bool {
+#ifdef __linux__
+  if (fd < 0)
+    return false;
+  int descriptor = inotify_add_watch(fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO);
+  if (descriptor < 0) {
+    std::cout << "ERROR::FILEWATCHER: Failed to watch " << directory << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+  watches.push_back({ descriptor, &changes });
+  return true;
+#else
+  std::cout << "ERROR::FILEWATCHER: Not supported on this platform, can't watch "
+            << directory << std::endl;
+  (void) changes;
+  return false;
+#endif
+}
+
+void FileWatcher::start(void (*notify)()) {
+  if (watches.empty() || running.exchange(true))
+    return;
+  this->notify = notify;
+  thread = std::thread(&FileWatcher::run, this);
+}
+
+void FileWatcher::stop() {
+  running = false;
+  if (thread.joinable())
+    thread.join();
+}
+
+void FileWatcher::run() {
+#ifdef __linux__
+  alignas(inotify_event) char buffer[4096];
+  pollfd readable = { fd, POLLIN, 0 };
+  while (running.load(std::memory_order_relaxed)) {
+    if (poll(&readable, 1, STOP_POLL) <= 0)
+      continue;
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+      double time = glfwGetTime();
+      bool changed = false;
+      for (char* at = buffer; at < buffer + length; ) {
+        const inotify_event* event = reinterpret_cast<const inotify_event*>(at);
+        at += sizeof(inotify_event) + event->len;
+        if (event->len == 0 || (event->mask & IN_ISDIR))
+          continue;
+        for (const Watch& watch : watches) {
+          if (watch.descriptor != event->wd)
+            continue;
+          FileChange change;
+          std::strncpy(change.name, event->name, sizeof(change.name) - 1);
+          change.time = time;
+          changed |= watch.changes->push(change);
+        }
+      }
+      if (changed && notify)
+        notify();
+    }
+  }
+#endif
+}
@@ -0,0 +1,126 @@
+#include <breakout/fixed-physics.hpp>
+
+#include <algorithm>
+
+void fixed_move_ball(BallObject& ball, float dt, unsigned int window_width) {
+  if (ball.stuck)
+    return;
+
+  Fixed2 position = Fixed2::from_float(ball.position);
+  Fixed2 velocity = Fixed2::from_float(ball.velocity);
+  Fixed  size     = Fixed::from_float(ball.size.x);
+  Fixed  right    = Fixed::from_int(window_width);
+  std::int64_t step = fixed_time(dt);
+
+  position.x += fixed_travel(velocity.x, step);
+  position.y += fixed_travel(velocity.y, step);
+  if (position.x <= Fixed()) {
+    velocity.x = -velocity.x;
+    position.x = Fixed();
+  } else if (position.x + size >= right) {
+    velocity.x = -velocity.x;
+    position.x = right - size;
+  }
+  if (position.y <= Fixed()) {
+    velocity.y = -velocity.y;
+    position.y = Fixed();
+  }
+
+  ball.position = position.to_float();
+  ball.velocity = velocity.to_float();
+}
+
+void fixed_advance(pgl::GameObject& object, float dt) {
+  Fixed2 position = Fixed2::from_float(object.position);
+  Fixed2 velocity = Fixed2::from_float(object.velocity);
+  std::int64_t step = fixed_time(dt);
+  position.x += fixed_travel(velocity.x, step);
+  position.y += fixed_travel(velocity.y, step);
+  object.position = position.to_float();
+}
+
+void fixed_speed_up(BallObject& ball) {
+  Fixed2 velocity = Fixed2::from_float(ball.velocity);
+  Fixed  factor   = Fixed::ratio(6, 5);
+  ball.velocity = Fixed2{ velocity.x * factor, velocity.y * factor }.to_float();
+}
+
+void fixed_count_down(float& seconds, float dt) {
+  // Q0.32 to Q16.16
+  Fixed step = Fixed::from_raw(static_cast<std::int32_t>(fixed_time(dt) >> 16));
+  seconds = (Fixed::from_float(seconds) - step).to_float();
+}
+
+auto fixed_check_overlap(const pgl::GameObject& one, const pgl::GameObject& two) -> bool {
+  Fixed2 a = Fixed2::from_float(one.position), a_size = Fixed2::from_float(one.size);
+  Fixed2 b = Fixed2::from_float(two.position), b_size = Fixed2::from_float(two.size);
+  bool collisionX = a.x + a_size.x >= b.x && b.x + b_size.x >= a.x;
+  bool collisionY = a.y + a_size.y >= b.y && b.y + b_size.y >= a.y;
+  return collisionX && collisionY;
+}
+
+auto fixed_box(const pgl::GameObject& object) -> FixedBox {
+  Fixed2 low = Fixed2::from_float(object.position);
+  return { low, low + Fixed2::from_float(object.size) };
+}
+
+auto fixed_circle(const BallObject& ball) -> FixedCircle {
+  Fixed radius = Fixed::from_float(ball.radius);
+  return { Fixed2::from_float(ball.position) + Fixed2{radius, radius}, radius };
+}
+
+auto fixed_direction(Fixed2 target) -> Direction {
+  // vector_direction picks the largest dot product of the normalized
+  // target with up, right, down, left; normalizing doesn't change which
+  // one that is, so compare the components directly. Like there, a zero
+  // vector matches nothing.
+  Fixed dots[] = { target.y, target.x, -target.y, -target.x };
+  Fixed max;
+  unsigned int best_match = -1;
+  for (unsigned int i = 0; i < 4; i++) {
+    if (dots[i] > max) {
+      max = dots[i];
+      best_match = i;
+    }
+  }
+  return (Direction)best_match;
+}
+
+void fixed_bounce(BallObject& ball, Direction dir, pgl::float2 difference) {
+  Fixed2 position = Fixed2::from_float(ball.position);
+  Fixed2 offset   = Fixed2::from_float(difference);
+  Fixed  radius   = Fixed::from_float(ball.radius);
+  if (dir == LEFT || dir == RIGHT) {
+    ball.velocity.x = -ball.velocity.x;
+    Fixed penetration = radius - abs(offset.x);
+    position.x += dir == LEFT ? penetration : -penetration;
+  } else {
+    ball.velocity.y = -ball.velocity.y;
+    Fixed penetration = radius - abs(offset.y);
+    position.y += dir == UP ? -penetration : penetration;
+  }
+  ball.position = position.to_float();
+}
+
+void fixed_deflect(BallObject& ball, const pgl::GameObject& paddle, float push) {
+  Fixed2 velocity = Fixed2::from_float(ball.velocity);
+  Fixed  half     = Fixed::from_float(paddle.size.x) / 2;
+  Fixed  center   = Fixed::from_float(paddle.position.x) + half;
+  Fixed  distance = Fixed::from_float(ball.position.x) + Fixed::from_float(ball.radius) - center;
+
+  // push * distance / half in one step, keeping all the precision
+  Fixed2 deflected = {
+    Fixed::from_raw(static_cast<std::int32_t>(
+      static_cast<std::int64_t>(distance.value()) * Fixed::from_float(push).value() / half.value())),
+    -abs(velocity.y)
+  };
+  Fixed speed = length(velocity);
+  Fixed norm  = length(deflected);
+  if (norm == Fixed())
+    return;
+  auto rescale = [&](Fixed component) {
+    return Fixed::from_raw(static_cast<std::int32_t>(
+      static_cast<std::int64_t>(component.value()) * speed.value() / norm.value()));
+  };
+  ball.velocity = Fixed2{ rescale(deflected.x), rescale(deflected.y) }.to_float();
+}
@@ -0,0 +1,160 @@
+#include <breakout/frame-capture.hpp>
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <utility>
+
+using Clock = std::chrono::steady_clock;
+
+// Longest wait for a frame's readback before giving up on it (ns)
+const GLuint64 FENCE_TIMEOUT = 1000000000;
+
+static auto seconds_since(Clock::time_point start) -> double {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+FrameCapture::FrameCapture(int width, int height, std::string directory)
+  : width(width), height(height), directory(std::move(directory)),
+    slots(), issued(0), collected(0), cost(), stalled(0.0),
+    pool(), free_images(), pending(), failed(0), quit(false),
+    mutex(), ready(), released(), worker()
+{
+  std::error_code error;
+  std::filesystem::create_directories(this->directory, error);
+  if (error)
+    std::cout << "ERROR::FRAMECAPTURE: Failed to create " << this->directory << ": "
+              << error.message() << std::endl;
+
+  GLsizeiptr size = GLsizeiptr(width) * height * 4;
+  for (Slot& slot : slots) {
+    glGenBuffers(1, &slot.pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  for (SoftImage& image : pool) {
+    image.resize(width, height);
+    free_images.push_back(&image);
+  }
+  worker = std::thread(&FrameCapture::encode, this);
+}
+
+FrameCapture::~FrameCapture() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    quit = true;
+  }
+  ready.notify_one();
+  worker.join();
+  for (Slot& slot : slots) {
+    if (slot.fence)
+      glDeleteSync(static_cast<GLsync>(slot.fence));
+    glDeleteBuffers(1, &slot.pbo);
+  }
+}
+
+void FrameCapture::capture() {
+  auto start = Clock::now();
+  Slot& slot = slots[issued % ring_size];
+  if (slot.fence)
+    collect(slot);
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slot.frame = issued++;
+  cost.add(seconds_since(start));
+}
+
+void FrameCapture::finish() {
+  auto start = Clock::now();
+  while (collected < issued) {
+    Slot& slot = slots[collected % ring_size];
+    if (slot.fence)
+      collect(slot);
+    else
+      ++collected;
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  released.wait(lock, [this] { return free_images.size() == pool_size; });
+  cost.add(seconds_since(start));
+}
+
+void FrameCapture::collect(Slot& slot) {
+  auto start = Clock::now();
+  GLsync fence = static_cast<GLsync>(slot.fence);
+  GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+  glDeleteSync(fence);
+  slot.fence = nullptr;
+  ++collected;
+  if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+    std::cout << "ERROR::FRAMECAPTURE: Readback of frame " << slot.frame << " never completed" << std::endl;
+    std::lock_guard<std::mutex> lock(mutex);
+    ++failed;
+    stalled += seconds_since(start);
+    return;
+  }
+
+  SoftImage* image;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    released.wait(lock, [this] { return !free_images.empty(); });
+    image = free_images.back();
+    free_images.pop_back();
+  }
+  stalled += seconds_since(start);
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+  const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, GLsizeiptr(width) * height * 4,
+                                        GL_MAP_READ_BIT);
+  if (mapped) {
+    // GL rows run bottom-up, SoftImage's top-down
+    const std::uint32_t* source = static_cast<const std::uint32_t*>(mapped);
+    for (int y = 0; y < height; ++y)
+      std::memcpy(image->row(y), source + std::size_t(height - 1 - y) * width,
+                  std::size_t(width) * 4);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (mapped) {
+    pending.push_back({ image, slot.frame });
+    ready.notify_one();
+  } else {
+    std::cout << "ERROR::FRAMECAPTURE: Failed to map frame " << slot.frame << std::endl;
+    ++failed;
+    free_images.push_back(image);
+  }
+}
+
+void FrameCapture::encode() {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    ready.wait(lock, [this] { return quit || !pending.empty(); });
+    if (pending.empty())
+      return;
+    Encoded next = pending.front();
+    pending.pop_front();
+    lock.unlock();
+
+    char file[32];
+    std::snprintf(file, sizeof(file), "/frame-%06u.ppm", next.frame);
+    bool written = write_ppm((directory + file).c_str(), *next.image);
+    if (!written)
+      std::cout << "ERROR::FRAMECAPTURE: Failed to write " << directory << file << std::endl;
+
+    lock.lock();
+    failed += written ? 0 : 1;
+    free_images.push_back(next.image);
+    released.notify_all();
+  }
+}
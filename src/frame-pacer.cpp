@@ -0,0 +1,85 @@
+#include <breakout/frame-pacer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <time.h>
+
+// The last stretch before a frame is spun rather than slept, as in
+// Simulation::run.
+const double SPIN_WINDOW = 0.0005;
+
+using Clock = std::chrono::steady_clock;
+
+static auto wall_time() -> double {
+  return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+}
+
+// CPU time consumed by the calling thread, so the simulation thread's
+// steady 120 Hz work doesn't hide what the render loop costs
+static auto thread_cpu_time() -> double {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+FramePacer::FramePacer(double rate)
+  : period(rate > 0.0 ? 1.0 / rate : 0.0), next(wall_time()), last_present(0.0),
+    previous_presented(false), intervals(), presented(0), skipped(0),
+    wall_mark(next), cpu_mark(thread_cpu_time()),
+    idle_wall(0.0), idle_cpu_time(0.0), active_wall(0.0), active_cpu_time(0.0)
+{
+
+}
+
+void FramePacer::wait() {
+  if (period <= 0.0)
+    return;
+  double now = wall_time();
+  if (next - now > SPIN_WINDOW)
+    std::this_thread::sleep_for(std::chrono::duration<double>(next - now - SPIN_WINDOW));
+  while ((now = wall_time()) < next)
+    std::this_thread::yield();
+}
+
+auto FramePacer::remaining() const -> double {
+  return period > 0.0 ? std::max(next - wall_time(), 0.0) : 0.0;
+}
+
+void FramePacer::end_frame(bool presented_frame, bool idle) {
+  double now = wall_time();
+  double cpu = thread_cpu_time();
+  if (idle) {
+    idle_wall     += now - wall_mark;
+    idle_cpu_time += cpu - cpu_mark;
+  } else {
+    active_wall     += now - wall_mark;
+    active_cpu_time += cpu - cpu_mark;
+  }
+  wall_mark = now;
+  cpu_mark  = cpu;
+
+  if (presented_frame) {
+    // only back-to-back frames measure pacing; the first one after a run
+    // of skipped frames would measure the idle stretch
+    if (presented > 0 && previous_presented)
+      intervals.add(now - last_present);
+    last_present = now;
+    ++presented;
+  } else {
+    ++skipped;
+  }
+  previous_presented = presented_frame;
+
+  // a late frame makes the next one due at once rather than starting a
+  // burst of catch-up frames
+  next = std::max(next + period, now);
+}
+
+auto FramePacer::idle_cpu() const -> double {
+  return idle_wall > 0.0 ? idle_cpu_time / idle_wall : 0.0;
+}
+
+auto FramePacer::active_cpu() const -> double {
+  return active_wall > 0.0 ? active_cpu_time / active_wall : 0.0;
+}
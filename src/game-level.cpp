@@ -1,74 +1,201 @@
 #include <breakout/game-level.hpp>
+#include <breakout/fixed-point.hpp>
+#include <breakout/mapped-file.hpp>
 
-void GameLevel::load(
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <string>
+#include <utility>
+
+// Where a tile starts: the rest of the line, up to 16 characters
+static auto excerpt(const char* at, const char* end) -> std::string {
+  const char* stop = at;
+  while (stop < end && stop - at < 16 && *stop != '\n' && *stop != '\r')
+    ++stop;
+  return std::string(at, stop);
+}
+
+auto parse_level(const char* begin, const char* end, const char* name, LevelTiles& tiles) -> bool {
+  tiles.width  = 0;
+  tiles.height = 0;
+  tiles.codes.clear();
+  tiles.bricks = 0;
+  // every code takes at least two bytes with its separator
+  tiles.codes.reserve((end - begin) / 2 + 1);
+
+  unsigned int line = 1;
+  const char* at = begin;
+  while (at < end) {
+    const char* row = at;
+    unsigned int count = 0;
+    for (;;) {
+      while (at < end && (*at == ' ' || *at == '\t' || *at == '\r'))
+        ++at;
+      if (at == end || *at == '\n')
+        break;
+      unsigned int code;
+      auto [next, error] = std::from_chars(at, end, code);
+      bool separated = next == end || *next == ' ' || *next == '\t' || *next == '\r' || *next == '\n';
+      if (error != std::errc() || !separated) {
+        std::cout << "ERROR::LEVEL: " << name << ":" << line << ":" << at - row + 1 << ": "
+                  << (error == std::errc::result_out_of_range ? "tile code out of range: "
+                                                               : "malformed tile code: ")
+                  << excerpt(at, end) << std::endl;
+        return false;
+      }
+      tiles.codes.push_back(static_cast<unsigned char>(std::min(code, 255u)));
+      tiles.bricks += code != 0;
+      ++count;
+      at = next;
+    }
+    if (count > 0) {
+      if (tiles.height == 0) {
+        tiles.width = count;
+      } else if (count != tiles.width) {
+        std::cout << "ERROR::LEVEL: " << name << ":" << line << ": row has " << count
+                  << " tiles, expected " << tiles.width << " like the first" << std::endl;
+        return false;
+      }
+      ++tiles.height;
+    }
+    if (at < end)
+      ++at;
+    ++line;
+  }
+  if (tiles.height == 0) {
+    std::cout << "ERROR::LEVEL: " << name << ": no tiles" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool GameLevel::load(
   const char* file,
   unsigned int level_width,
   unsigned int level_height)
 {
   // clear old data
   bricks.clear();
+  colliders.clear();
+  solid_count = 0;
 
-  // load from file
-  unsigned int tileCode;
-  GameLevel level;
-  std::string line;
-  std::ifstream fstream(file);
-  std::vector<std::vector<unsigned int>> tile_data;
-  if (fstream) {
-    while (std::getline(fstream, line)) { // read each line from level file
-      std::istringstream sstream(line);
-      std::vector<unsigned int> row;
-      while (sstream >> tileCode) // read each word seperated by spaces
-        row.push_back(tileCode);
-      tile_data.push_back(row);
-    }
-    if (tile_data.size() > 0)
-      init(tile_data, level_width, level_height);
+  // parse straight from the mapped file
+  MappedFile text(file);
+  if (!text.is_open()) {
+    std::cout << "ERROR::LEVEL: Failed to open " << file << std::endl;
+    return false;
   }
+  LevelTiles tiles;
+  if (!parse_level(text.data(), text.data() + text.size(), file, tiles))
+    return false;
+  init(tiles, level_width, level_height);
+  return true;
 }
 
 void GameLevel::init(
-  std::vector<std::vector<unsigned int>>& tile_data,
+  const LevelTiles& tiles,
   unsigned int level_width,
   unsigned int level_height)
 {
   // calculate dimensions
-  unsigned int height = tile_data.size();
-  unsigned int width  = tile_data[0].size();
-  float unit_width    = level_width / static_cast<float>(width);
-  float unit_height   = level_height / height;
-  // initialize level tiles based on tile_data		
+  unsigned int height = tiles.height;
+  unsigned int width  = tiles.width;
+  // integer division: the layout must not depend on floating-point flags,
+  // or fixed-point games would start from different bricks
+  float unit_width    = Fixed::ratio(level_width, width).to_float();
+  float unit_height   = Fixed::ratio(level_height, height).to_float();
+  pgl::float2 size(unit_width, unit_height);
+  // bricks are drawn from the atlas and carry no texture of their own
+  pgl::Texture2D no_texture;
+  bricks.reserve(tiles.bricks);
+  // initialize level tiles based on tile codes
+  const unsigned char* code = tiles.codes.data();
   for (unsigned int y = 0; y < height; ++y) {
-    for (unsigned int x = 0; x < width; ++x) {
+    for (unsigned int x = 0; x < width; ++x, ++code) {
       // check block type from level data (2D level array)
-      if (tile_data[y][x] == 1) { // solid
-        pgl::float2 pos(unit_width * x, unit_height * y);
-        pgl::float2 size(unit_width, unit_height);
-        pgl::GameObject obj(
-          pos, size, 
-          pgl::ResourceManager::get_texture("block_solid"), 
-          pgl::float3(0.8f, 0.8f, 0.7f));
+      if (*code == 0)
+        continue;
+      pgl::float2 pos(Fixed::ratio(level_width * x, width).to_float(),
+                      Fixed::ratio(level_height * y, height).to_float());
+      if (*code == 1) { // solid
+        pgl::GameObject obj(pos, size, no_texture, pgl::float3(0.8f, 0.8f, 0.7f));
         obj.is_solid = true;
         bricks.push_back(obj);
+        ++solid_count;
       }
-      else if (tile_data[y][x] > 1)	{
+      else {
         pgl::float3 color = pgl::float3(1.0f); // original: white
-        if (tile_data[y][x] == 2)
+        if (*code == 2)
           color = pgl::float3(0.2f, 0.6f, 1.0f);
-        else if (tile_data[y][x] == 3)
+        else if (*code == 3)
           color = pgl::float3(0.0f, 0.7f, 0.0f);
-        else if (tile_data[y][x] == 4)
+        else if (*code == 4)
           color = pgl::float3(0.8f, 0.8f, 0.4f);
-        else if (tile_data[y][x] == 5)
+        else if (*code == 5)
           color = pgl::float3(1.0f, 0.5f, 0.0f);
+        bricks.push_back(pgl::GameObject(pos, size, no_texture, color));
+      }
+    }
+  }
+  merge_solids(tiles, level_width, level_height);
+}
 
-        pgl::float2 pos(unit_width * x, unit_height * y);
-        pgl::float2 size(unit_width, unit_height);
-        bricks.push_back(
-          pgl::GameObject(pos, size, pgl::ResourceManager::get_texture("block"), color));
+void GameLevel::merge_solids(
+  const LevelTiles& tiles,
+  unsigned int level_width,
+  unsigned int level_height)
+{
+  // boxes in tile units, [x0, x1) by [y0, y1)
+  struct Box { unsigned int x0, x1, y0, y1; };
+  std::vector<Box> boxes;
+  // boxes reaching the previous row and the current one, left to right
+  std::vector<std::size_t> open, reaching;
+  unsigned int height = tiles.height;
+  unsigned int width  = tiles.width;
+  for (unsigned int y = 0; y < height; ++y) {
+    std::size_t candidate = 0;
+    reaching.clear();
+    for (unsigned int x = 0; x < width; ) {
+      if (tiles.at(x, y) != 1) {
+        ++x;
+        continue;
+      }
+      unsigned int end = x;
+      while (end < width && tiles.at(end, y) == 1)
+        ++end;
+      // the same run on the row above grows that box down instead
+      while (candidate < open.size() && boxes[open[candidate]].x0 < x)
+        ++candidate;
+      if (candidate < open.size() && boxes[open[candidate]].x0 == x
+          && boxes[open[candidate]].x1 == end) {
+        boxes[open[candidate]].y1 = y + 1;
+        reaching.push_back(open[candidate]);
+      } else {
+        reaching.push_back(boxes.size());
+        boxes.push_back({x, end, y, y + 1});
       }
+      x = end;
     }
-  }  
+    std::swap(open, reaching);
+  }
+
+  // same edges as the bricks they replace, see init
+  float unit_width  = Fixed::ratio(level_width, width).to_float();
+  float unit_height = Fixed::ratio(level_height, height).to_float();
+  pgl::Texture2D no_texture;
+  colliders.reserve(boxes.size());
+  for (const Box& box : boxes) {
+    float left   = Fixed::ratio(level_width * box.x0, width).to_float();
+    float right  = Fixed::ratio(level_width * (box.x1 - 1), width).to_float() + unit_width;
+    float top    = Fixed::ratio(level_height * box.y0, height).to_float();
+    float bottom = Fixed::ratio(level_height * (box.y1 - 1), height).to_float() + unit_height;
+    pgl::GameObject collider(
+      pgl::float2(left, top), pgl::float2(right - left, bottom - top),
+      no_texture, pgl::float3(0.8f, 0.8f, 0.7f));
+    collider.is_solid = true;
+    colliders.push_back(collider);
+  }
 }
 
 void GameLevel::draw(pgl::render2D::SpriteRenderer& renderer) {
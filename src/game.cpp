@@ -1,4 +1,12 @@
 #include <breakout/game.hpp>
+#include <breakout/texture-atlas.hpp>
+#include <breakout/sprite-batch.hpp>
+#include <breakout/particle-system.hpp>
+#include <breakout/fixed-physics.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
 
 // Initial size of the player paddle
 const pgl::float2 PLAYER_SIZE(100.0f, 20.0f);
@@ -9,20 +17,87 @@ const GLfloat PLAYER_VELOCITY(500.0f);
 const pgl::float2 INITIAL_BALL_VELOCITY(100.0f, -250.0f);
 // Radius of the ball object
 const float BALL_RADIUS = 12.5f;
+// Seed of the endless level unless overridden through Game::endless_seed
+const std::uint64_t DEFAULT_ENDLESS_SEED = 0x5EEDB10C;
+// Level files, in play order; the endless level comes after them
+const std::array<const char*, 4> LEVEL_FILES = {
+  "../resources/levels/one.lvl",
+  "../resources/levels/two.lvl",
+  "../resources/levels/three.lvl",
+  "../resources/levels/four.lvl"
+};
+// Programs loaded at startup: ResourceManager name, vertex and fragment file
+struct ShaderFiles {
+  const char* name;
+  const char* vertex;
+  const char* fragment;
+};
+const std::array<ShaderFiles, 5> SHADER_FILES = {{
+  { "sprite",         "../resources/shaders/sprite.vs",        "../resources/shaders/sprite.fs" },
+  { "particle",       "../resources/shaders/particle.vs",      "../resources/shaders/particle.fs" },
+  { "postprocessing", "../resources/shaders/postprocessor.vs", "../resources/shaders/postprocessor.fs" },
+  { "batch",          "../resources/shaders/batch.vs",         "../resources/shaders/batch.fs" },
+  { "text",           "../resources/shaders/text.vs",          "../resources/shaders/text.fs" }
+}};
+// Power-ups storage reserved up front; more can exist but will reallocate
+const std::size_t MAX_POWER_UPS = 64;
+// Sprites per batched draw call: a full level plus paddle, ball and power-ups
+const std::size_t BATCH_CAPACITY = 1024;
+// Lifetime of a spawned particle (s), as set by ParticleSystem
+const float PARTICLE_LIFE = 1.0f;
 
 pgl::GameObject*               player;
 BallObject*                    ball;
 pgl::render2D::SpriteRenderer* renderer;
-pgl::ParticleGenerator*        particles;
+TextureAtlas*                  atlas;
+SpriteBatch*                   batch;
+ParticleSystem*                particles;
 PostProcessor*                 effects;
+UniformBuffer*                 frame_uniforms;
 pgl::ui::TextRenderer*         text;
+ShaderCache*                   shader_cache;
 
 irrklang::ISoundEngine* sound_engine = irrklang::createIrrKlangDevice();
 
+// atlas regions of the batched sprites
+unsigned int face_region, block_region, block_solid_region, paddle_region;
+std::array<unsigned int, POWERUP_TYPES> powerup_regions;
+
+// Text drawn every frame, built once so rendering doesn't allocate
+const std::string WIN_TEXT         = "You WON!!!";
+const std::string WIN_RETRY_TEXT   = "Press ENTER to retry or ESC to quit";
+
 float shake_time = 0.0f;
 
+// "Lives:N", rewritten in place each frame
+std::string lives_text;
+
+// latency overlay percentiles, rewritten in place each frame
+std::string latency_text(64, ' ');
+
+// contents of frame_uniforms; only time and effects change between frames
+FrameData frame_data;
+
+// ball and paddle positions published with the previous snapshot
+pgl::float2 ball_published;
+pgl::float2 player_published;
+
+// Plays through irrKlang when a device could be opened (headless machines
+// usually have none). Whatever the engine allocates is billed to "audio".
+void play_sound(const char* file, bool loop) {
+  AllocationScope scope("audio");
+  if (sound_engine)
+    sound_engine->play2D(file, loop);
+}
+
 Game::Game(unsigned int width, unsigned int height)
-  : width(width), height(height)
+  : endless_seed(DEFAULT_ENDLESS_SEED), width(width), height(height),
+    input_stamps(), frame_latency(), latency_clock(nullptr), latency_overlay(nullptr),
+    burst_events(false), muted(false),
+    autopilot(false), fixed_point(false), fixed_bricks(), fixed_bricks_level(0),
+    msaa_samples(4), render_scale(1.0f), output_width(width), output_height(height),
+    output_framebuffer(0), shader_cache_directory(default_shader_cache()),
+    level_reloaded(0.0), shader_reloaded(0.0), last_frame(), particle_life(0.0f)
 {
 
 }
@@ -30,25 +105,29 @@ Game::Game(unsigned int width, unsigned int height)
 Game::~Game() { }
 
 void Game::init() {
-  lives = 3;
-  // load shaders
-	pgl::ResourceManager::load_shader(
-    "../resources/shaders/sprite.vs",
-    "../resources/shaders/sprite.fs",
-    "", "sprite");
-  pgl::ResourceManager::load_shader(
-    "../resources/shaders/particle.vs",
-    "../resources/shaders/particle.fs",
-    "", "particle");
-  pgl::ResourceManager::load_shader(
-    "../resources/shaders/postprocessor.vs",
-    "../resources/shaders/postprocessor.fs",
-    "", "postprocessing");
-  pgl::ResourceManager::load_shader(
-    "../resources/shaders/text.vs",
-    "../resources/shaders/text.fs",
-    "", "text"
-  );
+  load_resources();
+  init_world();
+}
+
+// Everything that needs a GL context: shaders, textures, renderers.
+void Game::load_resources() {
+  // load shaders: from the binary cache when an entry matches the
+  // sources and the driver, compiled otherwise
+  shader_cache = new ShaderCache(shader_cache_directory);
+  for (const ShaderFiles& files : SHADER_FILES)
+    pgl::ResourceManager::get_shader(files.name).id =
+      shader_cache->load(files.name, files.vertex, files.fragment);
+  const RunningStats& compiled = shader_cache->compile_time();
+  const RunningStats& cached   = shader_cache->load_time();
+  std::cout << "shaders: " << compiled.count() << " compiled in "
+            << compiled.mean() * compiled.count() * 1000.0 << " ms, "
+            << cached.count() << " from cache in "
+            << cached.mean() * cached.count() * 1000.0 << " ms";
+  if (shader_cache->enabled())
+    std::cout << ", " << shader_cache->invalidated() << " stale";
+  else
+    std::cout << ", cache off";
+  std::cout << std::endl;
 
   // configure shaders
 	pgl::float44 projection = pgl::ortho(
@@ -57,71 +136,96 @@ void Game::init() {
 
   pgl::ResourceManager::get_shader("sprite").use().setInteger("image", 0);
   pgl::ResourceManager::get_shader("sprite").setMatrix4("projection", projection);
-  pgl::ResourceManager::get_shader("particle").use().setInteger("sprite", 0);
-  pgl::ResourceManager::get_shader("particle").setMatrix4("projection", projection);
+  // the batch, particle and post-processing shaders read the projection,
+  // the clock and the effects from the Frame block, uploaded once a frame
+  frame_uniforms = new UniformBuffer();
+  frame_data.projection = ortho_projection(width, height);
 
   // set render-specific controls
   renderer = new pgl::render2D::SpriteRenderer(
 		pgl::ResourceManager::get_shader("sprite"));
   effects = new PostProcessor(
-		pgl::ResourceManager::get_shader("postprocessing"), width, height);
-  sound_engine->play2D("../resources/sound/breakout.mp3", true);
+		pgl::ResourceManager::get_shader("postprocessing"), output_width, output_height,
+    msaa_samples, render_scale);
+  effects->set_output_size(output_width, output_height, output_framebuffer);
+  render_scale = effects->get_scale();
+  if (!muted)
+    play_sound("../resources/sound/breakout.mp3", true);
 
   // load textures
-  pgl::ResourceManager::load_texture("../resources/textures/background.jpg",          false, "background");
-  pgl::ResourceManager::load_texture("../resources/textures/awesomeface.png",         true,  "face");
-  pgl::ResourceManager::load_texture("../resources/textures/block.png",               false, "block");
-  pgl::ResourceManager::load_texture("../resources/textures/block_solid.png",         false, "block_solid");
-  pgl::ResourceManager::load_texture("../resources/textures/paddle.png",              true,  "paddle");
-  pgl::ResourceManager::load_texture("../resources/textures/particle.png",            true,  "particle");
-  pgl::ResourceManager::load_texture("../resources/textures/powerup_speed.png",       true,  "powerup_speed");
-  pgl::ResourceManager::load_texture("../resources/textures/powerup_sticky.png",      true,  "powerup_sticky");
-  pgl::ResourceManager::load_texture("../resources/textures/powerup_increase.png",    true,  "powerup_increase");
-  pgl::ResourceManager::load_texture("../resources/textures/powerup_confuse.png",     true,  "powerup_confuse");
-  pgl::ResourceManager::load_texture("../resources/textures/powerup_chaos.png",       true,  "powerup_chaos");
-  pgl::ResourceManager::load_texture("../resources/textures/powerup_passthrough.png", true,  "powerup_passthrough");
+  pgl::ResourceManager::load_texture("../resources/textures/background.jpg", false, "background");
+  pgl::ResourceManager::load_texture("../resources/textures/particle.png",   true,  "particle");
+
+  // every other sprite shares one atlas page, drawn in a single batch
+  atlas = new TextureAtlas();
+  face_region        = atlas->add("face",        "../resources/textures/awesomeface.png", true);
+  block_region       = atlas->add("block",       "../resources/textures/block.png",       false);
+  block_solid_region = atlas->add("block_solid", "../resources/textures/block_solid.png", false);
+  paddle_region      = atlas->add("paddle",      "../resources/textures/paddle.png",      true);
+  powerup_regions[POWERUP_SPEED]             = atlas->add("powerup_speed",       "../resources/textures/powerup_speed.png",       true);
+  powerup_regions[POWERUP_STICKY]            = atlas->add("powerup_sticky",      "../resources/textures/powerup_sticky.png",      true);
+  powerup_regions[POWERUP_PAD_SIZE_INCREASE] = atlas->add("powerup_increase",    "../resources/textures/powerup_increase.png",    true);
+  powerup_regions[POWERUP_CONFUSE]           = atlas->add("powerup_confuse",     "../resources/textures/powerup_confuse.png",     true);
+  powerup_regions[POWERUP_CHAOS]             = atlas->add("powerup_chaos",       "../resources/textures/powerup_chaos.png",       true);
+  powerup_regions[POWERUP_PASS_THROUGH]      = atlas->add("powerup_passthrough", "../resources/textures/powerup_passthrough.png", true);
+  atlas->pack();
+  atlas->upload();
+  batch = new SpriteBatch(pgl::ResourceManager::get_shader("batch"), *atlas, BATCH_CAPACITY);
+
+  text = new pgl::ui::TextRenderer(
+		width, height, pgl::ResourceManager::get_shader("text"));
+  text->load("../resources/fonts/ocraext.TTF", 24);
+
+  particles = new ParticleSystem(
+    pgl::ResourceManager::get_shader("particle").id,
+    pgl::ResourceManager::get_texture("particle"),
+    PARTICLE_COUNT
+  );
+  burst_events = true;
+}
+
+// Game state only; safe to call without a GL context, which is how
+// headless runs and tests set up a game.
+void Game::init_world() {
+  lives = 3;
+
+  power_ups.reserve(MAX_POWER_UPS);
 
   // load levels
-  GameLevel one;   one.load  ("../resources/levels/one.lvl",   width, height / 2);
-  GameLevel two;   two.load  ("../resources/levels/two.lvl",   width, height / 2);
-  GameLevel three; three.load("../resources/levels/three.lvl", width, height / 2);
-  GameLevel four;  four.load ("../resources/levels/four.lvl",  width, height / 2);
-  levels.push_back(one);
-  levels.push_back(two);
-  levels.push_back(three);
-  levels.push_back(four);
+  levels.resize(LEVEL_FILES.size());
+  for (std::size_t i = 0; i < LEVEL_FILES.size(); ++i)
+    levels[i].load(LEVEL_FILES[i], width, height / 2);
+  endless.init(width, height / 2, endless_seed);
   level = 0;
 
   pgl::float2 player_pos = pgl::float2(
     width / 2.0f - PLAYER_SIZE.x / 2.0f,
     height - PLAYER_SIZE.y
   );
-  player = new pgl::GameObject(player_pos, PLAYER_SIZE, pgl::ResourceManager::get_texture("paddle"));
+  // sprites are drawn from the atlas: objects carry no texture of their own
+  player = new pgl::GameObject(player_pos, PLAYER_SIZE, pgl::Texture2D());
 
   pgl::float2 ball_pos = player_pos + pgl::float2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS,
                                             -BALL_RADIUS * 2.0f);
-  ball = new BallObject(ball_pos, BALL_RADIUS, INITIAL_BALL_VELOCITY,
-                        pgl::ResourceManager::get_texture("face"));
-  text = new pgl::ui::TextRenderer(
-		width, height, pgl::ResourceManager::get_shader("text"));
-  text->load("../resources/fonts/ocraext.TTF", 24);
-
-  particles = new pgl::ParticleGenerator(
-    pgl::ResourceManager::get_shader("particle"),
-    pgl::ResourceManager::get_texture("particle"),
-    500
-  );
+  ball = new BallObject(ball_pos, BALL_RADIUS, INITIAL_BALL_VELOCITY);
+  player_published = player->position;
+  ball_published   = ball->position;
 }
 
 void Game::update(float dt) {
-  ball->move(dt, width);
+  if (is_endless() && state == GAME_ACTIVE)
+    endless.update(dt);
+  if (fixed_point)
+    fixed_move_ball(*ball, dt, width);
+  else
+    ball->move(dt, width);
   process_collisions();
-  particles->update(dt, *ball, 2, pgl::float2(ball->radius / 2.0f));
+  dispatch_events();
 
   if (shake_time > 0.0f) {
     shake_time -= dt;
     if (shake_time <= 0.0f) {
-      effects->shake = false;
+      effect_state.shake = false;
     }
   }
   update_power_ups(dt);
@@ -135,96 +239,389 @@ void Game::update(float dt) {
     reset_player();
   }
 
-  if (state == GAME_ACTIVE && levels[level].isCompleted()) {
+  if (state == GAME_ACTIVE && !is_endless() && levels[level].isCompleted()) {
     reset_level();
     reset_player();
-    effects->chaos = true;
+    effect_state.chaos = true;
     state = GAME_WIN;
   }
 }
 
-void Game::render() {
-  if(state == GAME_ACTIVE || state == GAME_MENU) {
+auto frame_text(const WorldSnapshot& world, unsigned int height, std::string& lives,
+                std::array<TextLine, 2>& lines) -> unsigned int {
+  const pgl::float3 white(1.0f);
+  if (world.state == GAME_ACTIVE || world.state == GAME_MENU) {
+    // short enough for the small string buffer: no heap allocation
+    char text[16];
+    std::snprintf(text, sizeof(text), "Lives:%u", world.lives);
+    lives.assign(text);
+    lines[0] = { &lives, 5.0f, 5.0f, 1.0f, white };
+    return 1;
+  } else if (world.state == GAME_WIN) {
+    lines[0] = { &WIN_TEXT, 320.0f, height / 2 - 20.0f, 1.0f, pgl::float3(0.0f, 1.0f, 0.0f) };
+    lines[1] = { &WIN_RETRY_TEXT, 130.0f, height / 2.0f, 1.0f, pgl::float3(1.0f, 1.0f, 0.0f) };
+    return 2;
+  }
+  return 0;
+}
+
+void Game::render(WorldSnapshot& world, float alpha, float dt) {
+  frame_latency = world.input;
+  frame_latency.time[STAGE_RENDER] = glfwGetTime();
+  driver_calls().fill(0);
+  // simulation time rather than the wall clock, so that a replay renders
+  // the same frames however fast it runs
+  frame_data.time    = world.time;
+  frame_data.confuse = world.effects.confuse;
+  frame_data.chaos   = world.effects.chaos;
+  frame_data.shake   = world.effects.shake;
+  frame_uniforms->update(frame_data);
+
+  // a burst of particles wherever a brick broke since the last frame
+  GameEvent event;
+  while (render_events.pop(event)) {
+    pgl::GameObject origin;
+    origin.position = event.position;
+    particles->update(0.0f, origin, BURST_PARTICLES, event.size / 2.0f);
+    particle_life = PARTICLE_LIFE;
+  }
+  particle_life = std::max(particle_life - dt, 0.0f);
+
+  if(world.state == GAME_ACTIVE || world.state == GAME_MENU) {
+    // interpolate moving objects between the last two simulation ticks
+    pgl::GameObject player_pose = world.player;
+    player_pose.position = world.player_previous
+      + (world.player.position - world.player_previous) * alpha;
+    BallObject ball_pose = world.ball;
+    ball_pose.position = world.ball_previous
+      + (world.ball.position - world.ball_previous) * alpha;
+    // the trail follows a moving ball only, so a waiting ball lets the
+    // scene go still
+    unsigned int trail = ball_pose.stuck ? 0 : TRAIL_PARTICLES;
+    particles->update(dt, ball_pose, trail, pgl::float2(ball_pose.radius / 2.0f));
+    if (trail > 0)
+      particle_life = PARTICLE_LIFE;
+
     // draw background
     effects->begin_render();
     renderer->draw(
 			pgl::ResourceManager::get_texture("background"),
 			pgl::float2(0.0f, 0.0f), pgl::float2(width, height), 0.0f);
+    count_call(CALL_TEXTURE);
 
     // draw level
-    levels[level].draw(*renderer);
-    player->draw(*renderer);
+    batch->begin();
+    for (pgl::GameObject& brick : world.bricks)
+      if (!brick.destroyed)
+        batch->draw(brick.is_solid ? block_solid_region : block_region,
+                    brick.position, brick.size, brick.color);
+    batch->draw(paddle_region, player_pose.position, player_pose.size, player_pose.color);
+    batch->flush();
     particles->draw();
-		for (PowerUp &powerUp : power_ups) {
+    // the particles bound their own texture to unit 0
+    batch->invalidate();
+		for (PowerUp &powerUp : world.power_ups) {
 			if (!powerUp.destroyed) {
-				powerUp.draw(*renderer);
+				batch->draw(powerup_regions[powerUp.Type], powerUp.position, powerUp.size, powerUp.color);
 			}
 		}
-    ball->draw(*renderer);
+    batch->draw(face_region, ball_pose.position, ball_pose.size, ball_pose.color);
+    batch->flush();
     effects->end_render();
-    effects->render(glfwGetTime());
+    frame_latency.time[STAGE_SCENE] = glfwGetTime();
+    effects->render();
+    texture_binds.add(driver_calls()[CALL_TEXTURE]);
+  }
 
-    std::stringstream ss; ss << lives;
-    text->render_text("Lives:" + ss.str(), 5.0f, 5.0f, 1.0f);
+  std::array<TextLine, 2> lines;
+  unsigned int count = frame_text(world, height, lives_text, lines);
+  for (unsigned int i = 0; i < count; ++i)
+    text->render_text(*lines[i].text, lines[i].x, lines[i].y, lines[i].scale, lines[i].color);
 
-  } else if (state == GAME_MENU) {
-    text->render_text("Press ENTER to start", 250.0f, height / 2, 1.0f);
-    text->render_text("Press W or S to select level", 245.0f, height / 2 + 20.0f, 0.75f);
+  if (latency_overlay)
+    draw_latency_overlay();
 
-  } else if (state == GAME_WIN) {
-    text->render_text(
-      "You WON!!!", 320.0, height / 2 - 20.0, 1.0, pgl::float3(0.0, 1.0, 0.0)
-    );
-		text->render_text(
-      "Press ENTER to retry or ESC to quit",
-			130.0, height / 2, 1.0, pgl::float3(1.0, 1.0, 0.0)
-		);
+  for (unsigned int call = 0; call < DRIVER_CALLS; ++call)
+    gl_calls[call].add(driver_calls()[call]);
+  // the win screen has no scene pass
+  frame_latency.time[STAGE_POST] = glfwGetTime();
+  if (frame_latency.time[STAGE_SCENE] == 0.0)
+    frame_latency.time[STAGE_SCENE] = frame_latency.time[STAGE_RENDER];
+
+  last_frame.valid        = true;
+  last_frame.state        = world.state;
+  last_frame.level        = world.level;
+  last_frame.lives        = world.lives;
+  last_frame.player       = world.player.position;
+  last_frame.ball         = world.ball.position;
+  last_frame.player_width = world.player.size.x;
+}
+
+// Latency histogram in the top right corner: one bar per millisecond
+// over the recent key events, scaled to the tallest, then percentiles.
+void Game::draw_latency_overlay() {
+  const LatencyHistogram& histogram = *latency_overlay;
+  const float bar_width = 2.0f, bar_height = 40.0f;
+  const float left = width - LatencyHistogram::buckets * bar_width - 10.0f, top = 10.0f;
+  unsigned int tallest = 1;
+  for (unsigned int bucket = 0; bucket < LatencyHistogram::buckets; ++bucket)
+    tallest = std::max(tallest, histogram.recent(bucket));
+
+  batch->begin();
+  batch->draw(block_region, pgl::float2(left - 4.0f, top - 4.0f),
+              pgl::float2(LatencyHistogram::buckets * bar_width + 8.0f, bar_height + 8.0f),
+              pgl::float3(0.1f));
+  for (unsigned int bucket = 0; bucket < LatencyHistogram::buckets; ++bucket) {
+    if (histogram.recent(bucket) == 0)
+      continue;
+    float height = bar_height * histogram.recent(bucket) / tallest;
+    batch->draw(block_region, pgl::float2(left + bucket * bar_width, top + bar_height - height),
+                pgl::float2(bar_width, height), pgl::float3(0.3f, 1.0f, 0.4f));
+  }
+  batch->flush();
+
+  char label[64];
+  std::snprintf(label, sizeof(label), "input p50 %.0f p95 %.0f p99 %.0f ms",
+                histogram.percentile(0.5) * 1000.0, histogram.percentile(0.95) * 1000.0,
+                histogram.percentile(0.99) * 1000.0);
+  latency_text.assign(label);
+  text->render_text(latency_text, left, top + bar_height + 8.0f, 0.5f);
+}
+
+void Game::presented(const WorldSnapshot& world, double time) {
+  if (world.reloaded != last_frame.reloaded) {
+    reload_latency.add(time - world.reloaded);
+    last_frame.reloaded = world.reloaded;
+  }
+  if (shader_reloaded != 0.0) {
+    reload_latency.add(time - shader_reloaded);
+    shader_reloaded = 0.0;
+  }
+}
+
+auto Game::needs_redraw(const WorldSnapshot& world) const -> bool {
+  if (!last_frame.valid || particle_life > 0.0f)
+    return true;
+  // a key event gets its frame even if it changed nothing, which is what
+  // its latency is measured to
+  if (world.input.sequence != frame_latency.sequence)
+    return true;
+  // post-processing effects animate with the clock; the win screen is
+  // text only and never shows them
+  if (world.state != GAME_WIN
+      && (world.effects.confuse || world.effects.chaos || world.effects.shake))
+    return true;
+  // the endless level scrolls while it's played
+  if (world.state == GAME_ACTIVE && world.level == levels.size())
+    return true;
+  for (const PowerUp& power_up : world.power_ups)
+    if (!power_up.destroyed)
+      return true;
+  // anything that moved within the last tick is still being interpolated
+  auto moved = [](pgl::float2 a, pgl::float2 b) { return a.x != b.x || a.y != b.y; };
+  return world.state != last_frame.state
+      || world.reloaded != last_frame.reloaded
+      || world.level != last_frame.level
+      || world.lives != last_frame.lives
+      || world.player.size.x != last_frame.player_width
+      || moved(world.player.position, last_frame.player)
+      || moved(world.ball.position, last_frame.ball)
+      || moved(world.player_previous, world.player.position)
+      || moved(world.ball_previous, world.ball.position);
+}
+
+void Game::set_render_scale(float scale) {
+  render_scale = scale;
+  if (effects) {
+    effects->set_scale(scale);
+    render_scale = effects->get_scale();
   }
 }
 
+void Game::resize_output(unsigned int width, unsigned int height, unsigned int framebuffer) {
+  output_width  = width;
+  output_height = height;
+  output_framebuffer = framebuffer;
+  if (effects)
+    effects->set_output_size(width, height, framebuffer);
+}
+
+// Copies the renderable state into `world`. Called by the simulation
+// thread once per tick; vector assignment reuses the snapshot's storage.
+void Game::snapshot(WorldSnapshot& world, double time) {
+  if (world.power_ups.capacity() < MAX_POWER_UPS)
+    world.power_ups.reserve(MAX_POWER_UPS);
+  world.bricks    = bricks();
+  world.power_ups = power_ups;
+  world.player    = *player;
+  world.ball      = *ball;
+  world.player_previous = player_published;
+  world.ball_previous   = ball_published;
+  world.effects   = effect_state;
+  world.state     = state;
+  world.level     = level;
+  world.lives     = lives;
+  world.time      = time;
+  world.reloaded  = level_reloaded;
+  // the first snapshot after an event completes the tick that applied it
+  if (latency_clock && input_stamps.sequence != 0 && input_stamps.time[STAGE_UPDATE] == 0.0)
+    input_stamps.time[STAGE_UPDATE] = latency_clock();
+  world.input     = input_stamps;
+
+  player_published = player->position;
+  ball_published   = ball->position;
+}
+
 bool should_spawn(unsigned int chance) {
   unsigned int random = rand() % chance;
   return random == 0;
 }
 
-void Game::spawn_power_ups(pgl::GameObject& block) {
+void Game::spawn_power_ups(pgl::float2 position) {
   if (should_spawn(GOOD_RATE)) // 1 in GOOD_RATE chance
     power_ups.push_back(
-      PowerUp("speed", pgl::float3(0.5f, 0.5f, 1.0f), 0.0f,
-              block.position, pgl::ResourceManager::get_texture("powerup_speed")));
+      PowerUp(POWERUP_SPEED, pgl::float3(0.5f, 0.5f, 1.0f), 0.0f,
+              position));
   if (should_spawn(GOOD_RATE))
     power_ups.push_back(
-      PowerUp("sticky", pgl::float3(1.0f, 0.5f, 1.0f), 20.0f,
-              block.position, pgl::ResourceManager::get_texture("powerup_sticky")));
+      PowerUp(POWERUP_STICKY, pgl::float3(1.0f, 0.5f, 1.0f), 20.0f,
+              position));
   if (should_spawn(GOOD_RATE))
       power_ups.push_back(
         PowerUp(
-					"pass-through", pgl::float3(0.5f, 1.0f, 0.5f), 10.0f,
-					block.position, pgl::ResourceManager::get_texture("powerup_passthrough")));
+					POWERUP_PASS_THROUGH, pgl::float3(0.5f, 1.0f, 0.5f), 10.0f,
+					position));
   if (should_spawn(GOOD_RATE))
   power_ups.push_back(
-        PowerUp("pad-size-increase", pgl::float3(1.0f, 0.6f, 0.4), 0.0f,
-                block.position, pgl::ResourceManager::get_texture("powerup_increase")));
+        PowerUp(POWERUP_PAD_SIZE_INCREASE, pgl::float3(1.0f, 0.6f, 0.4), 0.0f,
+                position));
   if (should_spawn(BAD_RATE)) // negative powerups should spawn more often
     power_ups.push_back(
-      PowerUp("confuse", pgl::float3(1.0f, 0.3f, 0.3f), 5.0f,
-              block.position, pgl::ResourceManager::get_texture("powerup_confuse")));
+      PowerUp(POWERUP_CONFUSE, pgl::float3(1.0f, 0.3f, 0.3f), 5.0f,
+              position));
   if (should_spawn(BAD_RATE))
     power_ups.push_back(
-      PowerUp("chaos", pgl::float3(0.9f, 0.25f, 0.25f), 5.0f,
-              block.position, pgl::ResourceManager::get_texture("powerup_chaos")));
+      PowerUp(POWERUP_CHAOS, pgl::float3(0.9f, 0.25f, 0.25f), 5.0f,
+              position));
 }
 
 void Game::reset_level() {
   lives = 3;
-  if (level == 0)
-    levels[0].load("../resources/levels/one.lvl", width, height / 2);
-  else if (level == 1)
-    levels[1].load("../resources/levels/two.lvl", width, height / 2);
-  else if (level == 2)
-    levels[2].load("../resources/levels/three.lvl", width, height / 2);
-  else if (level == 3)
-    levels[3].load("../resources/levels/four.lvl", width, height / 2);
+  fixed_bricks.clear();
+  if (level < levels.size())
+    levels[level].load(LEVEL_FILES[level], width, height / 2);
+  else
+    endless.init(width, height / 2, endless_seed);
+}
+
+// true if `path` names the file `name` of some directory
+static auto same_file(const char* path, const char* name) -> bool {
+  const char* base = std::strrchr(path, '/');
+  return std::strcmp(base ? base + 1 : path, name) == 0;
+}
+
+void Game::apply_level_changes() {
+  FileChange change;
+  while (level_changes.pop(change)) {
+    for (std::size_t i = 0; i < LEVEL_FILES.size(); ++i) {
+      if (!same_file(LEVEL_FILES[i], change.name))
+        continue;
+      GameLevel reloaded;
+      // an unreadable or half-written file keeps the level as it was
+      if (!reloaded.load(LEVEL_FILES[i], width, height / 2)) {
+        std::cout << "ERROR::GAME: Could not reload " << LEVEL_FILES[i] << std::endl;
+        continue;
+      }
+      levels[i] = std::move(reloaded);
+      if (i == level)
+        fixed_bricks.clear();
+      level_reloaded = change.time;
+    }
+  }
+}
+
+// Programs of the game's own renderers, which can be rebuilt while
+// running, and how each renderer takes a new one; sprite and text belong
+// to pangolin's renderers and can't.
+struct ReloadableShader {
+  const char* name; // in SHADER_FILES
+  void (*swap)(unsigned int program);
+};
+const std::array<ReloadableShader, 3> RELOADABLE_SHADERS = {{
+  { "batch",          [](unsigned int program) { batch->set_program(program); } },
+  { "particle",       [](unsigned int program) { particles->set_program(program); } },
+  { "postprocessing", [](unsigned int program) { effects->set_program(program); } }
+}};
+// programs built by reloads, one per RELOADABLE_SHADERS entry, deleted
+// when replaced; the ones loaded at startup belong to the ResourceManager
+std::array<unsigned int, RELOADABLE_SHADERS.size()> reloaded_programs = {};
+
+static auto shader_files(const char* name) -> const ShaderFiles& {
+  return *std::find_if(SHADER_FILES.begin(), SHADER_FILES.end(),
+    [name](const ShaderFiles& files) { return std::strcmp(files.name, name) == 0; });
+}
+
+auto Game::apply_shader_changes() -> bool {
+  bool swapped = false;
+  FileChange change;
+  // one save per frame, so that a burst of them spreads its compiles over
+  // as many frames instead of stalling a single one
+  if (shader_changes.pop(change)) {
+    for (std::size_t i = 0; i < RELOADABLE_SHADERS.size(); ++i) {
+      const ShaderFiles& shader = shader_files(RELOADABLE_SHADERS[i].name);
+      if (!same_file(shader.vertex, change.name) && !same_file(shader.fragment, change.name))
+        continue;
+      // a failed build is reported and the running program kept; a good
+      // one replaces the cache entry, so the next launch starts with it
+      double start = glfwGetTime();
+      unsigned int program = shader_cache->load(shader.name, shader.vertex, shader.fragment);
+      reload_stall.add(glfwGetTime() - start);
+      if (program == 0)
+        continue;
+      RELOADABLE_SHADERS[i].swap(program);
+      if (reloaded_programs[i])
+        glDeleteProgram(reloaded_programs[i]);
+      reloaded_programs[i] = program;
+      if (shader_reloaded == 0.0)
+        shader_reloaded = change.time;
+      swapped = true;
+    }
+  }
+  return swapped;
+}
+
+auto Game::bricks() -> std::vector<pgl::GameObject>& {
+  return is_endless() ? endless.bricks : levels[level].bricks;
+}
+
+auto Game::colliders() -> std::vector<pgl::GameObject>& {
+  return is_endless() ? endless.colliders : levels[level].colliders;
+}
+
+static void hash_object(std::uint64_t& hash, const pgl::GameObject& object) {
+  float values[] = { object.position.x, object.position.y,
+                     object.size.x,     object.size.y,
+                     object.velocity.x, object.velocity.y };
+  hash_bytes(hash, values, sizeof(values));
+  hash_bytes(hash, &object.destroyed, sizeof(object.destroyed));
+}
+
+auto Game::state_hash() -> std::uint64_t {
+  std::uint64_t hash = FNV_OFFSET_BASIS;
+  hash_object(hash, *player);
+  hash_object(hash, *ball);
+  bool ball_state[] = { ball->stuck, ball->sticky, ball->pass_through };
+  hash_bytes(hash, ball_state, sizeof(ball_state));
+  for (const pgl::GameObject& brick : bricks())
+    hash_bytes(hash, &brick.destroyed, sizeof(brick.destroyed));
+  for (const PowerUp& powerUp : power_ups) {
+    hash_object(hash, powerUp);
+    hash_bytes(hash, &powerUp.Type, sizeof(powerUp.Type));
+    hash_bytes(hash, &powerUp.Activated, sizeof(powerUp.Activated));
+  }
+  unsigned int counters[] = { lives, level, static_cast<unsigned int>(state) };
+  hash_bytes(hash, counters, sizeof(counters));
+  return hash;
 }
 
 void Game::reset_player() {
@@ -239,73 +636,184 @@ void Game::reset_player() {
 							INITIAL_BALL_VELOCITY);
 }
 
-void Game::process_input(float dt) {
+// Consumes every queued input event stamped before `time`, the end of
+// the tick covering [time - dt, time]. Paddle motion is integrated
+// piecewise between events so that each key transition takes effect at
+// its own timestamp instead of at the next frame boundary.
+void Game::process_input(float dt, double time) {
+  // first thing in the tick, so a reloaded level never shows up halfway
+  // through one
+  apply_level_changes();
+  if (autopilot)
+    drive_autopilot(time);
+
+  double start  = time - dt;
+  double cursor = start;
+  InputEvent event;
+  while (input_queue.peek(event) && event.time <= time) {
+    input_queue.pop(event);
+    // events older than this tick are applied at its beginning
+    double at = std::max(event.time, start);
+    move_player(static_cast<float>(at - cursor));
+    cursor = at;
+    apply_input(event);
+    input_latency.add(time - event.time);
+    ++input_stamps.sequence;
+    input_stamps.time = {};
+    input_stamps.time[STAGE_EVENT] = event.time;
+    if (latency_clock)
+      input_stamps.time[STAGE_INPUT] = latency_clock();
+  }
+  move_player(static_cast<float>(time - cursor));
+}
+
+void Game::apply_input(const InputEvent& event) {
+  if (event.key < 0 || event.key >= 1024)
+    return;
+
+  if (event.action == GLFW_RELEASE) {
+    keys[event.key] = false;
+    key_processed[event.key] = false;
+    return;
+  }
+  if (event.action != GLFW_PRESS)
+    return;
+  keys[event.key] = true;
+
+  if (event.key == GLFW_KEY_P)
+    autopilot = !autopilot;
+
+  // discrete actions trigger on the press itself, so a tap shorter than a
+  // frame is never lost
   if (state == GAME_ACTIVE) {
-    float velocity = PLAYER_VELOCITY * dt;
-    // move playerboard
-    if (keys[GLFW_KEY_A]) {
-      if (player->position.x >= 0.0f) {
-        player->position.x -= velocity;
-        if (ball->stuck)
-          ball->position.x -= velocity;
-      }
-    }
-    if (keys[GLFW_KEY_D]) {
-      if (player->position.x <= width - player->size.x) {
-        player->position.x += velocity;
-        if (ball->stuck)
-          ball->position.x += velocity;
-      }
-    }
-    if (keys[GLFW_KEY_SPACE])
+    if (event.key == GLFW_KEY_SPACE)
       ball->stuck = false;
-  }
 
-  if (state == GAME_MENU && !key_processed[GLFW_KEY_ENTER]) {
-    if (keys[GLFW_KEY_ENTER]) {
+  } else if (state == GAME_MENU) {
+    if (event.key == GLFW_KEY_ENTER) {
       state = GAME_ACTIVE;
       key_processed[GLFW_KEY_ENTER] = true;
-    }
-    if (keys[GLFW_KEY_W] && !key_processed[GLFW_KEY_W]) {
-      level = (level + 1) % 4;
+    } else if (event.key == GLFW_KEY_W) {
+      level = (level + 1) % level_count();
       key_processed[GLFW_KEY_W] = true;
-    }
-    if (keys[GLFW_KEY_S] && !key_processed[GLFW_KEY_W]) {
+    } else if (event.key == GLFW_KEY_S) {
       if (level > 0)
         --level;
       else
-        level = 3;
+        level = level_count() - 1;
       key_processed[GLFW_KEY_S] = true;
     }
-  }
 
-  if (state == GAME_WIN) {
-    if (keys[GLFW_KEY_ENTER]) {
+  } else if (state == GAME_WIN) {
+    if (event.key == GLFW_KEY_ENTER) {
       key_processed[GLFW_KEY_ENTER] = true;
-      effects->chaos = false;
+      effect_state.chaos = false;
       state = GAME_MENU;
     }
   }
 }
 
+void Game::move_player(float dt) {
+  if (state != GAME_ACTIVE || dt <= 0.0f)
+    return;
+  if (fixed_point) {
+    move_player_fixed(dt);
+    return;
+  }
+
+  float velocity = PLAYER_VELOCITY * dt;
+  bool left  = keys[GLFW_KEY_A];
+  bool right = keys[GLFW_KEY_D];
+  if (autopilot) {
+    // same speed and bounds as a player, without overshooting the target
+    float delta = pilot.target() - (player->position.x + player->size.x / 2.0f);
+    velocity = std::min(velocity, std::abs(delta));
+    left  = delta < 0.0f;
+    right = delta > 0.0f;
+  }
+  // move playerboard
+  if (left) {
+    if (player->position.x >= 0.0f) {
+      player->position.x -= velocity;
+      if (ball->stuck)
+        ball->position.x -= velocity;
+    }
+  }
+  if (right) {
+    if (player->position.x <= width - player->size.x) {
+      player->position.x += velocity;
+      if (ball->stuck)
+        ball->position.x += velocity;
+    }
+  }
+}
+
+// move_player in integer math, for fixed-point mode
+void Game::move_player_fixed(float dt) {
+  Fixed velocity = fixed_travel(Fixed::from_float(PLAYER_VELOCITY), fixed_time(dt));
+  Fixed x    = Fixed::from_float(player->position.x);
+  Fixed size = Fixed::from_float(player->size.x);
+  bool left  = keys[GLFW_KEY_A];
+  bool right = keys[GLFW_KEY_D];
+  if (autopilot) {
+    Fixed delta = pilot.fixed_target() - (x + size / 2);
+    velocity = std::min(velocity, abs(delta));
+    left  = delta < Fixed();
+    right = delta > Fixed();
+  }
+  Fixed moved = x;
+  if (left && moved >= Fixed())
+    moved -= velocity;
+  if (right && moved <= Fixed::from_int(width) - size)
+    moved += velocity;
+  player->position.x = moved.to_float();
+  if (ball->stuck)
+    ball->position.x = (Fixed::from_float(ball->position.x) + moved - x).to_float();
+}
+
+// Plays the keyboard's part for unattended runs: starts games from the
+// menus, launches the ball and aims the paddle at the predicted landing.
+void Game::drive_autopilot(double time) {
+  if (state == GAME_MENU || state == GAME_WIN) {
+    apply_input({GLFW_KEY_ENTER, GLFW_PRESS, time});
+    apply_input({GLFW_KEY_ENTER, GLFW_RELEASE, time});
+    return;
+  }
+  pilot.plan(*player, *ball, bricks(), width, fixed_point);
+  if (ball->stuck)
+    ball->stuck = false;
+}
+
 void Game::process_collisions() {
-  for (pgl::GameObject& box: levels[level].bricks) {
-    if (!box.destroyed) {
-      Collision collision = CheckCollision(*ball, box);
+  std::vector<pgl::GameObject>& boxes = bricks();
+  std::vector<pgl::GameObject>& solids = colliders();
+  // solid bricks of a merged level are drawn but don't collide themselves
+  bool merged = !is_endless();
+  FixedCircle circle;
+  if (fixed_point) {
+    update_fixed_bricks();
+    circle = fixed_circle(*ball);
+  }
+  for (std::size_t i = 0; i < boxes.size() + solids.size(); ++i) {
+    pgl::GameObject& box = i < boxes.size() ? boxes[i] : solids[i - boxes.size()];
+    if (!box.destroyed && !(merged && box.is_solid && i < boxes.size())) {
+      Collision collision = fixed_point ? fixed_check_collision(circle, fixed_bricks[i])
+                                        : CheckCollision(*ball, box);
       if (std::get<0>(collision)) {
+        // side effects are only recorded here; dispatch_events runs them
         if (!box.is_solid) {
           box.destroyed = true;
-          this->spawn_power_ups(box);
-          sound_engine->play2D("../resources/sound/bleep.mp3", GL_FALSE);
-        } else {   // if block is solid, enable shake effect
-          shake_time = 0.05f;
-          effects->shake = true;
-          sound_engine->play2D("../resources/sound/solid.wav", GL_FALSE);
+          events.emit({EVENT_BRICK_DESTROYED, POWERUP_TYPES, box.position, box.size});
+        } else {
+          events.emit({EVENT_SOLID_HIT, POWERUP_TYPES, box.position, box.size});
         }
         Direction dir = std::get<1>(collision);
         pgl::float2 diff_vector = std::get<2>(collision);
         if (!(ball->pass_through && !box.is_solid)) {
-          if (dir == LEFT || dir == RIGHT) { // horizontal collision
+          if (fixed_point) {
+            fixed_bounce(*ball, dir, diff_vector);
+            circle = fixed_circle(*ball);
+          } else if (dir == LEFT || dir == RIGHT) { // horizontal collision
             ball->velocity.x = -ball->velocity.x; // reverse horizontal velocity
             // relocate
             float penetration = ball->radius - std::abs(diff_vector.x);
@@ -332,94 +840,164 @@ void Game::process_collisions() {
     if (!powerUp.destroyed) {
       if (powerUp.position.y >= height)
         powerUp.destroyed = true;
-      if (CheckCollision(*player, powerUp)) {
-        // collided with player, now activate powerup
-        ActivatePowerUp(powerUp);
+      if (fixed_point ? fixed_check_overlap(*player, powerUp)
+                      : CheckCollision(*player, powerUp)) {
+        // collided with player, activated by dispatch_events
         powerUp.destroyed = true;
         powerUp.Activated = true;
-        sound_engine->play2D("../resources/sound/powerup.wav", false);
+        events.emit({EVENT_POWERUP_COLLECTED, powerUp.Type, powerUp.position, powerUp.size});
       }
     }
   }
 
-  Collision result = CheckCollision(*ball, *player);
+  Collision result = fixed_point ? fixed_check_collision(*ball, *player)
+                                 : CheckCollision(*ball, *player);
   if (!ball->stuck && std::get<0>(result)) {
     // check where it hit the board, and change velocity based on where it hit the board
     ball->stuck = ball->sticky;
-    float centerBoard = player->position.x + player->size.x / 2.0f;
-    float distance = (ball->position.x + ball->radius) - centerBoard;
-    float percentage = distance / (player->size.x / 2.0f);
-
-    // then move accordingly
     float strength = 2.0f;
-    pgl::float2 oldvelocity = ball->velocity;
-    ball->velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
-    ball->velocity.y = -1.0f * std::abs(ball->velocity.y);
-		//TODO see if it works
-    ball->velocity = pgl::normalize(ball->velocity) * pgl::norm(oldvelocity);
-    sound_engine->play2D("../resources/sound/bleep.wav", false);
+    if (fixed_point) {
+      fixed_deflect(*ball, *player, INITIAL_BALL_VELOCITY.x * strength);
+    } else {
+      float centerBoard = player->position.x + player->size.x / 2.0f;
+      float distance = (ball->position.x + ball->radius) - centerBoard;
+      float percentage = distance / (player->size.x / 2.0f);
+
+      // then move accordingly
+      pgl::float2 oldvelocity = ball->velocity;
+      ball->velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
+      ball->velocity.y = -1.0f * std::abs(ball->velocity.y);
+      //TODO see if it works
+      ball->velocity = pgl::normalize(ball->velocity) * pgl::norm(oldvelocity);
+    }
+    events.emit({EVENT_PADDLE_HIT, POWERUP_TYPES, ball->position, ball->size});
   }
 }
 
-void ActivatePowerUp(PowerUp& powerUp) {
-  if (powerUp.Type == "speed") {
-    ball->velocity *= 1.2;
+// Runs the side effects the collision pass recorded this tick. Each sound
+// plays at most once per tick however many events asked for it.
+void Game::dispatch_events() {
+  bool bleep = false, solid = false, powerup = false, paddle = false;
+  for (const GameEvent& event : events) {
+    switch (event.type) {
+      case EVENT_BRICK_DESTROYED:
+        spawn_power_ups(event.position);
+        bleep = true;
+        break;
+      case EVENT_SOLID_HIT:
+        shake_time = 0.05f;
+        effect_state.shake = true;
+        solid = true;
+        break;
+      case EVENT_POWERUP_COLLECTED:
+        ActivatePowerUp(event.power_up, effect_state, fixed_point);
+        powerup = true;
+        break;
+      case EVENT_PADDLE_HIT:
+        paddle = true;
+        break;
+      default:
+        break;
+    }
+    // particles belong to the render thread; only forward when there is one
+    if (burst_events && event.type == EVENT_BRICK_DESTROYED)
+      render_events.push(event);
   }
-  else if (powerUp.Type == "sticky") {
+  if (bleep && !muted)
+    play_sound("../resources/sound/bleep.mp3");
+  if (solid && !muted)
+    play_sound("../resources/sound/solid.wav");
+  if (powerup && !muted)
+    play_sound("../resources/sound/powerup.wav");
+  if (paddle && !muted)
+    play_sound("../resources/sound/bleep.wav");
+  events.end_tick();
+}
+
+// Bricks only move when a level is (re)loaded or selected, except in
+// endless mode where they scroll every tick.
+void Game::update_fixed_bricks() {
+  std::vector<pgl::GameObject>& boxes = bricks();
+  std::vector<pgl::GameObject>& solids = colliders();
+  if (!is_endless() && fixed_bricks_level == level
+      && fixed_bricks.size() == boxes.size() + solids.size())
+    return;
+  fixed_bricks.clear();
+  for (const pgl::GameObject& box : boxes)
+    fixed_bricks.push_back(fixed_box(box));
+  for (const pgl::GameObject& box : solids)
+    fixed_bricks.push_back(fixed_box(box));
+  fixed_bricks_level = level;
+}
+
+void ActivatePowerUp(PowerUpType type, EffectState& effects, bool fixed_point) {
+  if (type == POWERUP_SPEED) {
+    if (fixed_point)
+      fixed_speed_up(*ball);
+    else
+      ball->velocity *= 1.2;
+  }
+  else if (type == POWERUP_STICKY) {
     ball->sticky = true;
     player->color = pgl::float3(1.0f, 0.5f, 1.0f);
   }
-  else if (powerUp.Type == "pass-through") {
+  else if (type == POWERUP_PASS_THROUGH) {
     ball->pass_through = true;
     ball->color = pgl::float3(1.0f, 0.5f, 0.5f);
   }
-  else if (powerUp.Type == "pad-size-increase") {
+  else if (type == POWERUP_PAD_SIZE_INCREASE) {
     player->size.x += 50;
   }
-  else if (powerUp.Type == "confuse") {
-    if (!effects->chaos)
-      effects->confuse = true; // only activate if chaos wasn't already active
+  else if (type == POWERUP_CONFUSE) {
+    if (!effects.chaos)
+      effects.confuse = true; // only activate if chaos wasn't already active
   }
-  else if (powerUp.Type == "chaos") {
-    if (!effects->confuse)
-      effects->chaos = true;
+  else if (type == POWERUP_CHAOS) {
+    if (!effects.confuse)
+      effects.chaos = true;
   }
 }
 
 void Game::update_power_ups(float dt) {
   for (PowerUp &powerUp : power_ups) {
-    powerUp.position += powerUp.velocity * dt;
+    if (fixed_point)
+      fixed_advance(powerUp, dt);
+    else
+      powerUp.position += powerUp.velocity * dt;
     if (powerUp.Activated) {
-      powerUp.Duration -= dt;
+      if (fixed_point)
+        fixed_count_down(powerUp.Duration, dt);
+      else
+        powerUp.Duration -= dt;
 
       if (powerUp.Duration <= 0.0f) {
         // remove powerup from list (will later be removed)
         powerUp.Activated = false;
         // deactivate effects
-        if (powerUp.Type == "sticky") {
-          if (!isOtherPowerUpActive(power_ups, "sticky")) {
+        if (powerUp.Type == POWERUP_STICKY) {
+          if (!isOtherPowerUpActive(power_ups, POWERUP_STICKY)) {
             // only reset if no other PowerUp of type sticky is active
             ball->sticky = false;
             player->color = pgl::float3(1.0f);
           }
         }
-        else if (powerUp.Type == "pass-through") {
-          if (!isOtherPowerUpActive(power_ups, "pass-through")) {
+        else if (powerUp.Type == POWERUP_PASS_THROUGH) {
+          if (!isOtherPowerUpActive(power_ups, POWERUP_PASS_THROUGH)) {
             // only reset if no other PowerUp of type pass-through is active
             ball->pass_through = false;
             ball->color = pgl::float3(1.0f);
           }
         }
-        else if (powerUp.Type == "confuse") {
-          if (!isOtherPowerUpActive(power_ups, "confuse")) {
+        else if (powerUp.Type == POWERUP_CONFUSE) {
+          if (!isOtherPowerUpActive(power_ups, POWERUP_CONFUSE)) {
             // only reset if no other PowerUp of type confuse is active
-            effects->confuse = false;
+            effect_state.confuse = false;
           }
         }
-        else if (powerUp.Type == "chaos") {
-          if (!isOtherPowerUpActive(power_ups, "chaos")) {
+        else if (powerUp.Type == POWERUP_CHAOS) {
+          if (!isOtherPowerUpActive(power_ups, POWERUP_CHAOS)) {
             // only reset if no other PowerUp of type chaos is active
-            effects->chaos = false;
+            effect_state.chaos = false;
           }
         }
       }
@@ -435,7 +1013,7 @@ void Game::update_power_ups(float dt) {
     power_ups.end());
 }
 
-bool isOtherPowerUpActive(std::vector<PowerUp>& powerUps, std::string type) {
+bool isOtherPowerUpActive(const std::vector<PowerUp>& powerUps, PowerUpType type) {
   for (const PowerUp &powerUp : powerUps) {
     if (powerUp.Activated)
       if (powerUp.Type == type)
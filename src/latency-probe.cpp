@@ -0,0 +1,131 @@
+#include <breakout/latency-probe.hpp>
+
+#include <glad/glad.h>
+#include <pangolin/glfw-support.hpp>
+
+#include <algorithm>
+#include <cstdio>
+
+auto latency_stage_name(LatencyStage stage) -> const char* {
+  switch (stage) {
+    case STAGE_EVENT:  return "event";
+    case STAGE_INPUT:  return "input";
+    case STAGE_UPDATE: return "update";
+    case STAGE_RENDER: return "render";
+    case STAGE_SCENE:  return "scene";
+    case STAGE_POST:   return "post-process";
+    case STAGE_SWAP:   return "swap";
+    case STAGE_GPU:    return "gpu";
+    default:           return "unknown";
+  }
+}
+
+// LatencyHistogram
+// ----------------
+
+LatencyHistogram::LatencyHistogram()
+  : recent_counts(), total_counts(), latest(), samples(0)
+{
+
+}
+
+void LatencyHistogram::add(double latency) {
+  unsigned int bucket = std::min(static_cast<unsigned int>(std::max(latency, 0.0) * 1000.0),
+                                 buckets - 1);
+  unsigned char& slot = latest[samples % window];
+  if (samples >= window)
+    --recent_counts[slot];
+  slot = static_cast<unsigned char>(bucket);
+  ++recent_counts[bucket];
+  ++total_counts[bucket];
+  ++samples;
+}
+
+auto LatencyHistogram::percentile(double fraction) const -> double {
+  unsigned int recent_samples = std::min(samples, window);
+  if (recent_samples == 0)
+    return 0.0;
+  unsigned int rank = std::max(1u, static_cast<unsigned int>(fraction * recent_samples + 0.5));
+  unsigned int seen = 0;
+  for (unsigned int bucket = 0; bucket < buckets; ++bucket) {
+    seen += recent_counts[bucket];
+    if (seen >= rank)
+      return (bucket + 1) / 1000.0;
+  }
+  return buckets / 1000.0;
+}
+
+auto LatencyHistogram::save_csv(const char* file) const -> bool {
+  std::FILE* out = std::fopen(file, "w");
+  if (!out)
+    return false;
+  std::fprintf(out, "from_ms,to_ms,frames,recent_frames\n");
+  for (unsigned int bucket = 0; bucket < buckets; ++bucket) {
+    // the last bucket is open-ended
+    if (bucket + 1 < buckets)
+      std::fprintf(out, "%u,%u,%u,%u\n", bucket, bucket + 1, total_counts[bucket], recent_counts[bucket]);
+    else
+      std::fprintf(out, "%u,,%u,%u\n", bucket, total_counts[bucket], recent_counts[bucket]);
+  }
+  return std::fclose(out) == 0;
+}
+
+// LatencyProbe
+// ------------
+
+LatencyProbe::LatencyProbe()
+  : queries(), pending(), issued(0), collected(0), last_sequence(0), lost(0),
+    latencies(), stages()
+{
+  glGenQueries(QUERIES, queries.data());
+}
+
+LatencyProbe::~LatencyProbe() {
+  glDeleteQueries(QUERIES, queries.data());
+}
+
+void LatencyProbe::presented(const LatencyStamps& stamps, double swap_time) {
+  collect();
+  // only the first frame to show an event measures it
+  if (stamps.sequence == 0 || stamps.sequence == last_sequence)
+    return;
+  last_sequence = stamps.sequence;
+
+  // every query still in flight: drop the oldest rather than wait for it
+  if (issued - collected == QUERIES) {
+    ++collected;
+    ++lost;
+  }
+  Pending& frame = pending[issued % QUERIES];
+  frame.stamps = stamps;
+  frame.stamps.time[STAGE_SWAP] = swap_time;
+  glQueryCounter(queries[issued % QUERIES], GL_TIMESTAMP);
+  // the GL clock has an arbitrary origin: pair it with glfwGetTime()
+  GLint64 gl_now = 0;
+  glGetInteger64v(GL_TIMESTAMP, &gl_now);
+  frame.gl_time = gl_now;
+  frame.time    = glfwGetTime();
+  ++issued;
+}
+
+void LatencyProbe::collect() {
+  while (collected < issued) {
+    unsigned int query = queries[collected % QUERIES];
+    GLint available = 0;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+      return;
+    GLuint64 finished = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &finished);
+
+    Pending& frame = pending[collected % QUERIES];
+    LatencyStamps& stamps = frame.stamps;
+    // a GPU that was already done can report a time before the swap
+    stamps.time[STAGE_GPU] = std::max(frame.time + (std::int64_t(finished) - frame.gl_time) * 1e-9,
+                                      stamps.time[STAGE_SWAP]);
+    latencies.add(stamps.time[STAGE_GPU] - stamps.time[STAGE_EVENT]);
+    for (unsigned int stage = STAGE_INPUT; stage < LATENCY_STAGES; ++stage)
+      stages[stage].add(stamps.time[stage] - stamps.time[stage - 1]);
+    ++collected;
+  }
+}
@@ -0,0 +1,69 @@
+#include <breakout/mapped-file.hpp>
+
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Files smaller than this are read: for a few pages, setting up and
+// tearing down a mapping costs more than copying them (bytes)
+const std::size_t MAP_THRESHOLD = 64 * 1024;
+
+MappedFile::MappedFile(const char* file)
+  : open(false), begin(nullptr), length(0), mapped(false), buffer()
+{
+#if defined(__unix__) || defined(__APPLE__)
+  int fd = ::open(file, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return;
+  struct stat status;
+  bool regular = fstat(fd, &status) == 0 && S_ISREG(status.st_mode);
+  std::size_t size = regular ? status.st_size : 0;
+  if (size >= MAP_THRESHOLD) {
+    void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view != MAP_FAILED) {
+      // parsers read it front to back, once
+      madvise(view, size, MADV_SEQUENTIAL);
+      begin  = static_cast<const char*>(view);
+      length = size;
+      mapped = true;
+      open   = true;
+    }
+  }
+  // small files are read, and so are large ones mmap refused
+  if (regular && !mapped) {
+    buffer.resize(size);
+    std::size_t done = 0;
+    ssize_t count = 0;
+    while (done < size && (count = read(fd, buffer.data() + done, size - done)) > 0)
+      done += count;
+    buffer.resize(done);
+    begin  = buffer.data();
+    length = done;
+    open   = count >= 0;
+  }
+  close(fd);
+  // pipes and special files have no size to go by; stream those
+  if (open || regular)
+    return;
+#endif
+  std::ifstream fstream(file, std::ios::binary);
+  if (!fstream)
+    return;
+  buffer.assign(std::istreambuf_iterator<char>(fstream), std::istreambuf_iterator<char>());
+  begin  = buffer.data();
+  length = buffer.size();
+  open   = true;
+}
+
+MappedFile::~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+  if (mapped)
+    munmap(const_cast<char*>(begin), length);
+#endif
+}
@@ -0,0 +1,147 @@
+#include <breakout/particle-system.hpp>
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+// ParticlePool
+// ------------
+
+ParticlePool::ParticlePool(unsigned int amount)
+  : pool(amount, Particle{ pgl::float2(0.0f), pgl::float2(0.0f), 1.0f, 1.0f, 1.0f, 1.0f, 0.0f }),
+    last_used(0), random()
+{
+
+}
+
+void ParticlePool::update(float dt, const pgl::GameObject& object,
+                          unsigned int new_particles, pgl::float2 offset) {
+  for (unsigned int i = 0; i < new_particles; ++i)
+    respawn(pool[first_unused()], object, offset);
+
+  for (Particle& particle : pool) {
+    particle.life -= dt;
+    if (particle.life > 0.0f) {
+      particle.position = particle.position - particle.velocity * dt;
+      particle.a -= dt * 2.5f;
+    }
+  }
+}
+
+// Dead particles are usually right after the last one reused, so the
+// search starts there before wrapping around; when none is dead the first
+// one is overwritten.
+auto ParticlePool::first_unused() -> unsigned int {
+  for (unsigned int i = last_used; i < pool.size(); ++i)
+    if (pool[i].life <= 0.0f)
+      return last_used = i;
+  for (unsigned int i = 0; i < last_used; ++i)
+    if (pool[i].life <= 0.0f)
+      return last_used = i;
+  return last_used = 0;
+}
+
+void ParticlePool::respawn(Particle& particle, const pgl::GameObject& object, pgl::float2 offset) {
+  float spread = (static_cast<int>(random() % 100) - 50) / 10.0f;
+  float shade  = 0.5f + ((random() % 100) / 100.0f);
+  particle.position = object.position + pgl::float2(spread) + offset;
+  particle.r = particle.g = particle.b = shade;
+  particle.a = 1.0f;
+  particle.life = 1.0f;
+  particle.velocity = object.velocity * 0.1f;
+}
+
+// ParticleSystem
+// --------------
+
+ParticleSystem::ParticleSystem(unsigned int program, pgl::Texture2D texture, unsigned int amount)
+  : shader(program), texture(texture), particles(amount), instances(),
+    vao(0), quad_vbo(0), instance_vbo(0)
+{
+  instances.reserve(amount);
+
+  float quad[] = {
+    // pos      // tex
+    0.0f, 1.0f, 0.0f, 1.0f,
+    1.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 0.0f,
+
+    0.0f, 1.0f, 0.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 0.0f, 1.0f, 0.0f
+  };
+  glGenVertexArrays(1, &vao);
+  glGenBuffers(1, &quad_vbo);
+  glGenBuffers(1, &instance_vbo);
+  glBindVertexArray(vao);
+
+  glBindBuffer(GL_ARRAY_BUFFER, quad_vbo);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*) 0);
+
+  glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+  glBufferData(GL_ARRAY_BUFFER, amount * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*) offsetof(Instance, x));
+  glVertexAttribDivisor(1, 1);
+  glEnableVertexAttribArray(2);
+  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*) offsetof(Instance, r));
+  glVertexAttribDivisor(2, 1);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+
+  configure_program();
+}
+
+ParticleSystem::~ParticleSystem() {
+  glDeleteBuffers(1, &instance_vbo);
+  glDeleteBuffers(1, &quad_vbo);
+  glDeleteVertexArrays(1, &vao);
+}
+
+void ParticleSystem::set_program(unsigned int program) {
+  shader = ShaderProgram(program);
+  configure_program();
+}
+
+void ParticleSystem::configure_program() {
+  shader.use();
+  shader.set(shader.location("sprite"), 0);
+  shader.bind_block("Frame", FRAME_BINDING);
+}
+
+void ParticleSystem::update(float dt, const pgl::GameObject& object,
+                            unsigned int new_particles, pgl::float2 offset) {
+  particles.update(dt, object, new_particles, offset);
+}
+
+void ParticleSystem::draw() {
+  instances.clear();
+  for (const ParticlePool::Particle& particle : particles.particles())
+    if (particle.life > 0.0f)
+      instances.push_back({ particle.position.x, particle.position.y,
+                            particle.r, particle.g, particle.b, particle.a });
+  if (instances.empty())
+    return;
+
+  // additive blending gives the particles their glow
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+  shader.use();
+  glActiveTexture(GL_TEXTURE0);
+  texture.bind();
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+  // orphan the previous contents so the driver doesn't wait on the GPU
+  glBufferData(GL_ARRAY_BUFFER, particles.particles().size() * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(Instance), instances.data());
+  glDrawArraysInstanced(GL_TRIANGLES, 0, 6, instances.size());
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  count_call(CALL_BIND);
+  count_call(CALL_TEXTURE);
+  count_call(CALL_UPLOAD, 2);
+  count_call(CALL_DRAW);
+}
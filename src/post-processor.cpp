@@ -1,55 +1,48 @@
 #include <breakout/post-processor.hpp>
 
+#include <algorithm>
+#include <cmath>
+
+// Smallest accepted resolution scale
+const float MIN_SCALE = 0.25f;
+
 PostProcessor::PostProcessor(
   pgl::Shader& shader, unsigned int width,
-  unsigned int height)
+  unsigned int height, unsigned int samples, float scale)
   :
     post_processing_shader(shader),
     texture(), width(width),
-    height(height), confuse(false),
-    chaos(false), shake(false)
+    height(height),
+    MSFBO(0), FBO(0), RBO(0), VAO(0), output(0),
+    samples(samples), scale(std::clamp(scale, MIN_SCALE, 1.0f)),
+    target_width(0), target_height(0)
 {
   // initialize renderbuffer/framebuffer object
   glGenFramebuffers(1, &MSFBO);
   glGenFramebuffers(1, &FBO);
   glGenRenderbuffers(1, &RBO);
 
-  // initialize renderbuffer storage with a multisampled color buffer (don't
-  // need a depth/stencil buffer)
-  glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
-  glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
-
-  // allocate storage for render buffer object
-  glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_RGB, width, height);
-
-  // attach MS render buffer object to framebuffer
-  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->RBO);
-
-  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-    std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
-
-  // also initialize the FBO/texture to blit multisampled color-buffer to; used
-  // for shader operations (for postprocessing effects)
-  glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+  // the texture to blit the multisampled color-buffer to; used for shader
+  // operations (for postprocessing effects)
 	pgl::Image img;
 	img.width = width;
 	img.height = height;
   texture.generate(img); // TODO carefull it may not be right
+  allocate_targets();
 
-  // attach texture to framebuffer as its color attachment
-  glFramebufferTexture2D(
-    GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-    GL_TEXTURE_2D, texture.id, 0
-  );
-
-  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-    std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
-
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
   // initialize render data and uniforms
   init_render_data();
-  post_processing_shader.setInteger("scene", 0);
+  init_uniforms();
+}
+
+void PostProcessor::set_program(unsigned int program) {
+  post_processing_shader.id = program;
+  init_uniforms();
+}
+
+void PostProcessor::init_uniforms() {
   post_processing_shader.use();
+  post_processing_shader.setInteger("scene", 0);
   float offset = 1.0f / 300.0f;
   float offsets[9][2] = {
     { -offset,  offset  },  // top-left
@@ -81,10 +74,69 @@ PostProcessor::PostProcessor(
     1.0f/16.0f, 2.0f/16.0f, 1.0f/16.0f
   };
   glUniform1fv(glGetUniformLocation(post_processing_shader.id, "blur_kernel"), 9, blur_kernel);
+  ShaderProgram(post_processing_shader.id).bind_block("Frame", FRAME_BINDING);
+}
+
+void PostProcessor::set_scale(float scale) {
+  scale = std::clamp(scale, MIN_SCALE, 1.0f);
+  if (scale == this->scale)
+    return;
+  this->scale = scale;
+  allocate_targets();
+}
+
+void PostProcessor::set_output_size(unsigned int width, unsigned int height,
+                                    unsigned int framebuffer) {
+  output = framebuffer;
+  if (width == this->width && height == this->height)
+    return;
+  this->width  = width;
+  this->height = height;
+  allocate_targets();
+}
+
+void PostProcessor::allocate_targets() {
+  unsigned int w = std::max(1u, static_cast<unsigned int>(std::lround(width  * scale)));
+  unsigned int h = std::max(1u, static_cast<unsigned int>(std::lround(height * scale)));
+  if (w == target_width && h == target_height)
+    return;
+  target_width  = w;
+  target_height = h;
+
+  // the resolved scene is magnified by the final pass, so sample it
+  // linearly; chaos scrolls its coordinates, which have to repeat
+  texture.bind();
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+  // attach texture to framebuffer as its color attachment
+  glFramebufferTexture2D(
+    GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+    GL_TEXTURE_2D, texture.id, 0
+  );
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
+
+  if (samples > 0) {
+    // multisampled color buffer (don't need a depth/stencil buffer)
+    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGB, w, h);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->RBO);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+      std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void PostProcessor::begin_render() {
-  glBindFramebuffer(GL_FRAMEBUFFER, MSFBO);
+  glBindFramebuffer(GL_FRAMEBUFFER, samples > 0 ? MSFBO : FBO);
+  glViewport(0, 0, target_width, target_height);
   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT);
 }
@@ -92,30 +144,32 @@ void PostProcessor::begin_render() {
 void PostProcessor::end_render() {
   // now resolve multisampled color-buffer into intermediate FBO to store to
   // texture
-  glBindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
-  glBlitFramebuffer(
-    0, 0, width, height, 0, 0, width, height,
-    GL_COLOR_BUFFER_BIT, GL_NEAREST
-  );
-
-  // binds both READ and WRITE framebuffer to default framebuffer
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  if (samples > 0) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
+    glBlitFramebuffer(
+      0, 0, target_width, target_height, 0, 0, target_width, target_height,
+      GL_COLOR_BUFFER_BIT, GL_NEAREST
+    );
+  }
+
+  // binds both READ and WRITE framebuffer to the output framebuffer, which
+  // the final pass and the text cover at full size
+  glBindFramebuffer(GL_FRAMEBUFFER, output);
+  glViewport(0, 0, width, height);
 }
 
-void PostProcessor::render(float time) {
-  // set uniforms/options
+void PostProcessor::render() {
   post_processing_shader.use();
-  post_processing_shader.setFloat("time", time);
-  post_processing_shader.setInteger("confuse", confuse);
-  post_processing_shader.setInteger("chaos", chaos);
-  post_processing_shader.setInteger("shake", shake);
   // render textured quad
   glActiveTexture(GL_TEXTURE0);
   texture.bind();
   glBindVertexArray(this->VAO);
   glDrawArrays(GL_TRIANGLES, 0, 6);
   glBindVertexArray(0);
+  count_call(CALL_BIND, 2);
+  count_call(CALL_TEXTURE);
+  count_call(CALL_DRAW);
 }
 
 void PostProcessor::init_render_data() {
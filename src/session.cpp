@@ -0,0 +1,105 @@
+#include <breakout/session.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+auto load_session(const char* file, Session& session) -> bool {
+  std::ifstream fstream(file);
+  if (!fstream) {
+    std::cout << "ERROR::SESSION: Failed to open " << file << std::endl;
+    return false;
+  }
+  session = Session();
+
+  std::string line, key;
+  unsigned int number = 0;
+  while (std::getline(fstream, line)) {
+    ++number;
+    std::istringstream sstream(line);
+    if (!(sstream >> key) || key[0] == '#')
+      continue;
+
+    bool ok = true;
+    if (key == "level") {
+      ok = bool(sstream >> session.level);
+    } else if (key == "seed") {
+      ok = bool(sstream >> session.seed);
+    } else if (key == "endless") {
+      std::string value;
+      ok = bool(sstream >> value);
+      session.endless = std::strtoull(value.c_str(), nullptr, 0);
+    } else if (key == "autopilot") {
+      ok = bool(sstream >> session.autopilot);
+    } else if (key == "fixed_point") {
+      ok = bool(sstream >> session.fixed_point);
+    } else if (key == "rate") {
+      ok = bool(sstream >> session.rate) && session.rate > 0.0;
+    } else if (key == "ticks") {
+      ok = bool(sstream >> session.ticks);
+    } else if (key == "event") {
+      InputEvent event;
+      ok = bool(sstream >> event.time >> event.key >> event.action);
+      if (ok)
+        session.events.push_back(event);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      std::cout << "ERROR::SESSION: " << file << ":" << number
+                << ": cannot parse '" << line << "'" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+auto save_session(const char* file, const Session& session) -> bool {
+  std::ofstream fstream(file);
+  if (!fstream) {
+    std::cout << "ERROR::SESSION: Failed to write " << file << std::endl;
+    return false;
+  }
+  fstream << "level "       << session.level       << "\n"
+          << "seed "        << session.seed        << "\n"
+          << "endless 0x"   << std::hex << session.endless << std::dec << "\n"
+          << "autopilot "   << session.autopilot   << "\n"
+          << "fixed_point " << session.fixed_point << "\n"
+          << "rate "        << session.rate        << "\n"
+          << "ticks "       << session.ticks       << "\n";
+  fstream.precision(9);
+  for (const InputEvent& event : session.events)
+    fstream << "event " << event.time << " " << event.key << " " << event.action << "\n";
+  return bool(fstream);
+}
+
+SessionReplay::SessionReplay(Game& game, const Session& session)
+  : game(game), session(session), next_event(0), current(0)
+{
+  std::srand(session.seed);
+  game.endless_seed = session.endless;
+  game.level     = std::min(session.level, game.level_count() - 1);
+  game.autopilot = session.autopilot;
+  game.fixed_point = session.fixed_point;
+  game.state     = GAME_MENU;
+  game.reset_level();
+  game.reset_player();
+}
+
+auto SessionReplay::tick() -> bool {
+  if (current >= session.ticks)
+    return false;
+  ++current;
+
+  float  dt   = static_cast<float>(1.0 / session.rate);
+  double time = current / session.rate;
+  while (next_event < session.events.size() && session.events[next_event].time <= time) {
+    if (!game.input_queue.push(session.events[next_event]))
+      break; // full: try again next tick
+    ++next_event;
+  }
+  game.process_input(dt, time);
+  game.update(dt);
+  return true;
+}
@@ -0,0 +1,166 @@
+#include <breakout/shader-cache.hpp>
+#include <breakout/shader-program.hpp>
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// First bytes of an entry, bumped whenever its layout changes
+const char CACHE_MAGIC[8] = { 'B', 'K', 'P', 'R', 'O', 'G', '0', '1' };
+
+// Layout of an entry: this header, then `length` bytes of binary
+struct CacheHeader {
+  char          magic[8];
+  std::uint64_t key;
+  std::uint32_t format;
+  std::uint32_t length;
+};
+
+// hashes the terminator too, so that "ab" + "c" and "a" + "bc" differ
+static void hash_string(std::uint64_t& hash, const char* text) {
+  hash_bytes(hash, text, text ? std::strlen(text) + 1 : 0);
+}
+
+static auto seconds_since(Clock::time_point start) -> double {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+auto default_shader_cache() -> std::string {
+  if (const char* cache = std::getenv("XDG_CACHE_HOME"); cache && *cache)
+    return std::string(cache) + "/breakout/shaders";
+  if (const char* home = std::getenv("HOME"); home && *home)
+    return std::string(home) + "/.cache/breakout/shaders";
+  return std::string();
+}
+
+ShaderCache::ShaderCache(std::string directory)
+  : directory(std::move(directory)), driver(FNV_OFFSET_BASIS), supported(false),
+    compiled(), loaded(), stale(0)
+{
+  GLint formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  supported = formats > 0 && !this->directory.empty();
+  if (!supported)
+    return;
+
+  std::error_code error;
+  std::filesystem::create_directories(this->directory, error);
+  if (error) {
+    std::cout << "ERROR::SHADER_CACHE: Failed to create " << this->directory << ": "
+              << error.message() << std::endl;
+    supported = false;
+    return;
+  }
+  for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+    hash_string(driver, reinterpret_cast<const char*>(glGetString(name)));
+}
+
+auto ShaderCache::entry(const char* name) const -> std::string {
+  return directory + "/" + name + ".bin";
+}
+
+auto ShaderCache::load(const char* name, const char* vertex_file,
+                       const char* fragment_file) -> unsigned int {
+  auto start = Clock::now();
+  std::string vertex_source, fragment_source;
+  if (!read_source(vertex_file, vertex_source) || !read_source(fragment_file, fragment_source))
+    return 0;
+
+  std::uint64_t key = driver;
+  hash_string(key, vertex_source.c_str());
+  hash_string(key, fragment_source.c_str());
+  std::string file = supported ? entry(name) : std::string();
+  if (supported) {
+    unsigned int program = load_binary(file, key);
+    if (program) {
+      loaded.add(seconds_since(start));
+      return program;
+    }
+  }
+
+  unsigned int program = compile_program(vertex_source, fragment_source, vertex_file, supported);
+  if (program && supported)
+    save_binary(file, key, program);
+  compiled.add(seconds_since(start));
+  return program;
+}
+
+auto ShaderCache::load_binary(const std::string& file, std::uint64_t key) -> unsigned int {
+  std::FILE* in = std::fopen(file.c_str(), "rb");
+  if (!in)
+    return 0; // not cached yet
+  CacheHeader header;
+  std::vector<char> binary;
+  bool valid = std::fread(&header, sizeof(header), 1, in) == 1
+            && std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0
+            && header.key == key;
+  if (valid) {
+    // a truncated or corrupted entry must not size the allocation
+    long start = std::ftell(in);
+    valid = start >= 0 && std::fseek(in, 0, SEEK_END) == 0
+         && std::ftell(in) - start == long(header.length)
+         && std::fseek(in, start, SEEK_SET) == 0;
+  }
+  if (valid) {
+    binary.resize(header.length);
+    valid = std::fread(binary.data(), 1, binary.size(), in) == binary.size();
+  }
+  std::fclose(in);
+  if (!valid) {
+    ++stale;
+    return 0;
+  }
+
+  GLuint program = glCreateProgram();
+  glProgramBinary(program, header.format, binary.data(), header.length);
+  GLint success = 0;
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success) {
+    // e.g. a driver update that kept its version string
+    glDeleteProgram(program);
+    ++stale;
+    return 0;
+  }
+  return program;
+}
+
+void ShaderCache::save_binary(const std::string& file, std::uint64_t key, unsigned int program) {
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+  std::vector<char> binary(length);
+  GLenum format = 0;
+  glGetProgramBinary(program, length, &length, &format, binary.data());
+
+  CacheHeader header;
+  std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  header.key    = key;
+  header.format = format;
+  header.length = length;
+  // written aside and renamed over the entry, so a crash or a concurrent
+  // launch never reads half a file
+  std::string written = file + ".tmp";
+  std::FILE* out = std::fopen(written.c_str(), "wb");
+  bool saved = out
+            && std::fwrite(&header, sizeof(header), 1, out) == 1
+            && std::fwrite(binary.data(), 1, length, out) == std::size_t(length);
+  if (out)
+    saved = std::fclose(out) == 0 && saved;
+  std::error_code error;
+  if (saved)
+    std::filesystem::rename(written, file, error);
+  if (!saved || error) {
+    std::cout << "ERROR::SHADER_CACHE: Failed to save " << file << std::endl;
+    std::filesystem::remove(written, error);
+  }
+}
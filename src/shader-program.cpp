@@ -0,0 +1,185 @@
+#include <breakout/shader-program.hpp>
+
+#include <glad/glad.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static_assert(sizeof(FrameData) == 80, "FrameData must match the std140 Frame block");
+
+// driver calls counted since the last reset, see driver_calls()
+static std::array<unsigned int, DRIVER_CALLS> gl_calls = {};
+
+auto driver_calls() -> std::array<unsigned int, DRIVER_CALLS>& {
+  return gl_calls;
+}
+
+auto driver_call_name(DriverCall call) -> const char* {
+  switch (call) {
+    case CALL_DRAW:    return "draws";
+    case CALL_BIND:    return "binds";
+    case CALL_TEXTURE: return "texture binds";
+    case CALL_UNIFORM: return "uniforms";
+    case CALL_UPLOAD:  return "uploads";
+    default:           return "unknown";
+  }
+}
+
+ShaderProgram::ShaderProgram() : program(0), uniforms() { }
+
+ShaderProgram::ShaderProgram(unsigned int program) : program(program), uniforms() {
+  GLint count = 0, longest = 0;
+  glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+  glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &longest);
+  std::vector<char> name(longest + 1);
+  for (GLint i = 0; i < count; ++i) {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    glGetActiveUniform(program, i, name.size(), &length, &size, &type, name.data());
+    std::string uniform(name.data(), length);
+    int location = glGetUniformLocation(program, uniform.c_str());
+    // members of uniform blocks have no location
+    if (location < 0)
+      continue;
+    // arrays are reported as "name[0]"
+    if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0)
+      uniform.resize(uniform.size() - 3);
+    uniforms.emplace_back(uniform, location);
+  }
+}
+
+void ShaderProgram::use() const {
+  glUseProgram(program);
+  count_call(CALL_BIND);
+}
+
+auto ShaderProgram::location(const char* name) const -> int {
+  for (const auto& [uniform, location] : uniforms)
+    if (uniform == name)
+      return location;
+  return -1;
+}
+
+void ShaderProgram::set(int location, int value) const {
+  glUniform1i(location, value);
+  count_call(CALL_UNIFORM);
+}
+
+void ShaderProgram::set(int location, float value) const {
+  glUniform1f(location, value);
+  count_call(CALL_UNIFORM);
+}
+
+void ShaderProgram::set(int location, pgl::float2 value) const {
+  glUniform2f(location, value.x, value.y);
+  count_call(CALL_UNIFORM);
+}
+
+void ShaderProgram::bind_block(const char* name, unsigned int binding) const {
+  GLuint index = glGetUniformBlockIndex(program, name);
+  if (index != GL_INVALID_INDEX)
+    glUniformBlockBinding(program, index, binding);
+}
+
+auto read_source(const char* file, std::string& source) -> bool {
+  std::ifstream stream(file, std::ios::binary);
+  if (!stream) {
+    std::cout << "ERROR::SHADER: Failed to read " << file << std::endl;
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << stream.rdbuf();
+  source = buffer.str();
+  return true;
+}
+
+static auto compile_stage(GLenum stage, const std::string& source, const char* name) -> GLuint {
+  const char* text = source.c_str();
+  GLuint shader = glCreateShader(stage);
+  glShaderSource(shader, 1, &text, nullptr);
+  glCompileShader(shader);
+  GLint success = 0;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+  if (!success) {
+    char log[1024];
+    glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+    std::cout << "ERROR::SHADER: Compile-time error in " << name << "\n" << log << std::endl;
+    glDeleteShader(shader);
+    return 0;
+  }
+  return shader;
+}
+
+// links two compiled stages, 0 if either failed; deletes the stages
+static auto link_program(GLuint vertex, GLuint fragment, const char* name,
+                         bool retrievable) -> GLuint {
+  GLuint program = 0;
+  if (vertex && fragment) {
+    program = glCreateProgram();
+    if (retrievable)
+      glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+      char log[1024];
+      glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+      std::cout << "ERROR::SHADER: Link-time error for " << name << "\n" << log << std::endl;
+      glDeleteProgram(program);
+      program = 0;
+    }
+  }
+  // a linked program keeps its stages alive for as long as it needs them
+  glDeleteShader(vertex);
+  glDeleteShader(fragment);
+  return program;
+}
+
+auto compile_program(const char* vertex_file, const char* fragment_file) -> unsigned int {
+  std::string vertex_source, fragment_source;
+  if (!read_source(vertex_file, vertex_source) || !read_source(fragment_file, fragment_source))
+    return 0;
+  GLuint vertex   = compile_stage(GL_VERTEX_SHADER, vertex_source, vertex_file);
+  GLuint fragment = compile_stage(GL_FRAGMENT_SHADER, fragment_source, fragment_file);
+  return link_program(vertex, fragment, vertex_file, false);
+}
+
+auto compile_program(const std::string& vertex_source, const std::string& fragment_source,
+                     const char* name, bool retrievable) -> unsigned int {
+  GLuint vertex   = compile_stage(GL_VERTEX_SHADER, vertex_source, name);
+  GLuint fragment = compile_stage(GL_FRAGMENT_SHADER, fragment_source, name);
+  return link_program(vertex, fragment, name, retrievable);
+}
+
+auto ortho_projection(float width, float height) -> std::array<float, 16> {
+  // glm::ortho(0, width, height, 0, -1, 1)
+  return {
+    2.0f / width, 0.0f,            0.0f,  0.0f,
+    0.0f,         -2.0f / height,  0.0f,  0.0f,
+    0.0f,         0.0f,           -1.0f,  0.0f,
+    -1.0f,        1.0f,            0.0f,  1.0f
+  };
+}
+
+UniformBuffer::UniformBuffer() : ubo(0) {
+  glGenBuffers(1, &ubo);
+  glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_BINDING, ubo);
+}
+
+UniformBuffer::~UniformBuffer() {
+  glDeleteBuffers(1, &ubo);
+}
+
+void UniformBuffer::update(const FrameData& data) {
+  glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  count_call(CALL_UPLOAD);
+}
@@ -0,0 +1,77 @@
+#include <breakout/simulation.hpp>
+
+#include <chrono>
+
+// Past this many ticks of lag the simulation drops the backlog instead of
+// running a burst of catch-up ticks, which keeps jitter bounded.
+const unsigned int MAX_CATCHUP_TICKS = 4;
+// The last stretch before a tick is spun rather than slept, since the
+// scheduler's wake-up granularity is coarser than we want.
+const double SPIN_WINDOW = 0.0005;
+
+Simulation::Simulation(Game& game, double tick_rate)
+  : game(game), tick_period(1.0 / tick_rate), snapshots(),
+    thread(), running(false), tick_jitter(), skipped(0)
+{
+
+}
+
+Simulation::~Simulation() {
+  stop();
+}
+
+void Simulation::start() {
+  if (running.exchange(true))
+    return;
+  // publish the initial state so the renderer never sees an empty world
+  game.snapshot(snapshots.write_buffer(), glfwGetTime());
+  snapshots.publish();
+  thread = std::thread(&Simulation::run, this);
+}
+
+void Simulation::stop() {
+  running = false;
+  if (thread.joinable())
+    thread.join();
+}
+
+auto Simulation::acquire() -> WorldSnapshot& {
+  snapshots.update();
+  return snapshots.read_buffer();
+}
+
+void Simulation::run() {
+  double next = glfwGetTime() + tick_period;
+  while (running.load(std::memory_order_relaxed)) {
+    double now = glfwGetTime();
+    if (next - now > SPIN_WINDOW) {
+      std::this_thread::sleep_for(
+        std::chrono::duration<double>(next - now - SPIN_WINDOW));
+    }
+    while ((now = glfwGetTime()) < next)
+      std::this_thread::yield();
+
+    tick_jitter.add(now - next);
+
+    {
+      AllocationScope scope("input");
+      game.process_input(tick_period, next);
+    }
+    {
+      AllocationScope scope("update");
+      game.update(tick_period);
+    }
+    {
+      AllocationScope scope("snapshot");
+      game.snapshot(snapshots.write_buffer(), next);
+      snapshots.publish();
+    }
+
+    next += tick_period;
+    if (now - next > MAX_CATCHUP_TICKS * tick_period) {
+      std::uint64_t behind = (now - next) / tick_period;
+      skipped += behind;
+      next += behind * tick_period;
+    }
+  }
+}
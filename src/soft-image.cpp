@@ -0,0 +1,52 @@
+#include <breakout/soft-image.hpp>
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+void SoftImage::resize(int width, int height) {
+  this->width  = width;
+  this->height = height;
+  pixels.assign(static_cast<std::size_t>(width) * height, OPAQUE_BLACK);
+}
+
+auto load_soft_image(const char* file, SoftImage& image) -> bool {
+  int width, height, channels;
+  unsigned char* data = stbi_load(file, &width, &height, &channels, 4);
+  if (!data) {
+    std::cout << "ERROR::SOFT_IMAGE: Failed to load " << file << std::endl;
+    return false;
+  }
+  image.width  = width;
+  image.height = height;
+  image.pixels.resize(static_cast<std::size_t>(width) * height);
+  std::memcpy(image.pixels.data(), data, image.pixels.size() * sizeof(std::uint32_t));
+  stbi_image_free(data);
+
+  image.opaque = std::all_of(
+    image.pixels.begin(), image.pixels.end(),
+    [](std::uint32_t texel) { return (texel & ALPHA_MASK) == ALPHA_MASK; });
+  return true;
+}
+
+auto write_ppm(const char* file, const SoftImage& image) -> bool {
+  std::FILE* out = std::fopen(file, "wb");
+  if (!out)
+    return false;
+  std::fprintf(out, "P6\n%d %d\n255\n", image.width, image.height);
+  // a row at a time: one fwrite per pixel costs more than the conversion
+  std::vector<unsigned char> rgb(std::size_t(image.width) * 3);
+  for (int y = 0; y < image.height; ++y) {
+    const std::uint32_t* pixel = image.row(y);
+    for (std::size_t x = 0; x < rgb.size(); x += 3, ++pixel) {
+      rgb[x]     = static_cast<unsigned char>(*pixel);
+      rgb[x + 1] = static_cast<unsigned char>(*pixel >> 8);
+      rgb[x + 2] = static_cast<unsigned char>(*pixel >> 16);
+    }
+    std::fwrite(rgb.data(), 1, rgb.size(), out);
+  }
+  return std::fclose(out) == 0;
+}
@@ -0,0 +1,568 @@
+#include <breakout/software-renderer.hpp>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Fragment stage selected by postprocessor.fs (chaos > confuse > shake)
+enum PostMode {
+  POST_COPY,
+  POST_INVERT,
+  POST_BLUR,
+  POST_EDGE
+};
+
+// RowPool
+// -------
+
+RowPool::RowPool(unsigned int threads)
+  : workers(), mutex(), wake(), finished(),
+    job(nullptr), context(nullptr), rows(0),
+    generation(0), pending(0), quit(false)
+{
+  for (unsigned int i = 1; i < std::max(threads, 1u); ++i)
+    workers.emplace_back(&RowPool::work, this, i);
+}
+
+RowPool::~RowPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    quit = true;
+  }
+  wake.notify_all();
+  for (std::thread& worker : workers)
+    worker.join();
+}
+
+void RowPool::run(int rows, Job job, void* context) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->job     = job;
+    this->context = context;
+    this->rows    = rows;
+    pending = workers.size();
+    ++generation;
+  }
+  wake.notify_all();
+  band(0);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [this] { return pending == 0; });
+}
+
+void RowPool::work(unsigned int index) {
+  unsigned int seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [&] { return quit || generation != seen; });
+      if (quit)
+        return;
+      seen = generation;
+    }
+    band(index);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--pending == 0)
+        finished.notify_one();
+    }
+  }
+}
+
+void RowPool::band(unsigned int index) {
+  int n     = size();
+  int begin = rows * static_cast<int>(index) / n;
+  int end   = rows * static_cast<int>(index + 1) / n;
+  if (begin < end)
+    job(context, begin, end);
+}
+
+// sprite blitting
+// ---------------
+
+// per-channel multipliers in 1/256 units, alpha untouched
+struct Tint {
+  int r, g, b;
+};
+
+static inline auto tint_and_blend(
+  std::uint32_t texel, std::uint32_t dst, const Tint& tint) -> std::uint32_t
+{
+  unsigned int a = texel >> 24;
+  a += a >> 7; // 0..256
+  unsigned int inv = 256 - a;
+  unsigned int r = (( texel        & 0xFF) * tint.r >> 8) * a + ( dst        & 0xFF) * inv;
+  unsigned int g = (((texel >> 8)  & 0xFF) * tint.g >> 8) * a + ((dst >> 8)  & 0xFF) * inv;
+  unsigned int b = (((texel >> 16) & 0xFF) * tint.b >> 8) * a + ((dst >> 16) & 0xFF) * inv;
+  return (r >> 8) | ((g >> 8) << 8) | ((b >> 8) << 16) | OPAQUE_BLACK;
+}
+
+// Draws `n` destination pixels sampling `texels` at 16.16 fixed point
+// steps (nearest filtering), tinting and alpha blending like sprite.fs
+// with GL_SRC_ALPHA / GL_ONE_MINUS_SRC_ALPHA.
+static void blend_span(
+  std::uint32_t* dst, const std::uint32_t* texels, int last_texel,
+  std::uint32_t u, std::uint32_t du, int n, const Tint& tint, bool plain)
+{
+  auto texel = [&](std::uint32_t at) {
+    return texels[std::min(static_cast<int>(at >> 16), last_texel)];
+  };
+
+  if (plain) { // opaque, untinted: a scaled copy
+    for (int i = 0; i < n; ++i, u += du)
+      dst[i] = texel(u);
+    return;
+  }
+
+  int i = 0;
+#if defined(__SSE2__)
+  const __m128i zero   = _mm_setzero_si128();
+  const __m128i tint16 = _mm_setr_epi16(tint.r, tint.g, tint.b, 256, tint.r, tint.g, tint.b, 256);
+  const __m128i full   = _mm_set1_epi16(256);
+  const __m128i opaque = _mm_set1_epi32(static_cast<int>(OPAQUE_BLACK));
+
+  auto blend2 = [&](__m128i src, __m128i dest) {
+    src = _mm_srli_epi16(_mm_mullo_epi16(src, tint16), 8);
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    a = _mm_add_epi16(a, _mm_srli_epi16(a, 7));
+    __m128i inv = _mm_sub_epi16(full, a);
+    return _mm_srli_epi16(
+      _mm_add_epi16(_mm_mullo_epi16(src, a), _mm_mullo_epi16(dest, inv)), 8);
+  };
+
+  for (; i + 4 <= n; i += 4, u += 4 * du) {
+    __m128i src = _mm_setr_epi32(
+      static_cast<int>(texel(u)),          static_cast<int>(texel(u + du)),
+      static_cast<int>(texel(u + 2 * du)), static_cast<int>(texel(u + 3 * du)));
+    __m128i dest = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    __m128i lo = blend2(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dest, zero));
+    __m128i hi = blend2(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dest, zero));
+    _mm_storeu_si128(
+      reinterpret_cast<__m128i*>(dst + i),
+      _mm_or_si128(_mm_packus_epi16(lo, hi), opaque));
+  }
+#endif
+  for (; i < n; ++i, u += du)
+    dst[i] = tint_and_blend(texel(u), dst[i], tint);
+}
+
+// Adds `n` destination pixels of a particle like particle.fs with
+// GL_SRC_ALPHA / GL_ONE: the tinted texel is clamped to 1, as a fixed
+// point framebuffer does, then added weighted by its alpha.
+static void add_span(
+  std::uint32_t* dst, const std::uint32_t* texels, int last_texel,
+  std::uint32_t u, std::uint32_t du, int n, const Tint& tint, int alpha)
+{
+  for (int i = 0; i < n; ++i, u += du) {
+    std::uint32_t texel = texels[std::min(static_cast<int>(u >> 16), last_texel)];
+    unsigned int a = (texel >> 24) * alpha >> 8;
+    a += a >> 7; // 0..256
+    std::uint32_t out = OPAQUE_BLACK;
+    const int tints[3] = { tint.r, tint.g, tint.b };
+    for (int channel = 0; channel < 3; ++channel) {
+      int shift = channel * 8;
+      unsigned int source = std::min(((texel >> shift) & 0xFF) * tints[channel] >> 8, 255u);
+      unsigned int sum    = ((dst[i] >> shift) & 0xFF) + (source * a >> 8);
+      out |= std::min(sum, 255u) << shift;
+    }
+    dst[i] = out;
+  }
+}
+
+static void blit(SoftImage& dst, const SoftImage& texture,
+                 float x, float y, float w, float h, pgl::float3 color,
+                 int band_begin, int band_end, float alpha = 1.0f, bool additive = false)
+{
+  if (texture.width == 0 || w <= 0.0f || h <= 0.0f)
+    return;
+  int x0 = std::max(0, static_cast<int>(std::lround(x)));
+  int x1 = std::min(dst.width, static_cast<int>(std::lround(x + w)));
+  int y0 = std::max(band_begin, static_cast<int>(std::lround(y)));
+  int y1 = std::min(band_end, static_cast<int>(std::lround(y + h)));
+  if (x0 >= x1 || y0 >= y1)
+    return;
+
+  // a particle's tint goes up to 1.5: the product is clamped instead
+  float most = additive ? 2.0f : 1.0f;
+  auto channel = [most](float c) {
+    return static_cast<int>(std::clamp(c, 0.0f, most) * 256.0f + 0.5f);
+  };
+  Tint tint{channel(color.x), channel(color.y), channel(color.z)};
+  bool plain = texture.opaque && tint.r == 256 && tint.g == 256 && tint.b == 256;
+
+  float scale_x = texture.width / w;
+  float scale_y = texture.height / h;
+  auto du = static_cast<std::uint32_t>(scale_x * 65536.0f);
+  auto u0 = static_cast<std::uint32_t>(std::max(0.0f, (x0 + 0.5f - x) * scale_x) * 65536.0f);
+  int fade = static_cast<int>(std::clamp(alpha, 0.0f, 1.0f) * 256.0f + 0.5f);
+  for (int row = y0; row < y1; ++row) {
+    int v = std::min(static_cast<int>((row + 0.5f - y) * scale_y), texture.height - 1);
+    if (additive)
+      add_span(dst.row(row) + x0, texture.row(std::max(v, 0)), texture.width - 1,
+               u0, du, x1 - x0, tint, fade);
+    else
+      blend_span(dst.row(row) + x0, texture.row(std::max(v, 0)), texture.width - 1,
+                 u0, du, x1 - x0, tint, plain);
+  }
+}
+
+// post-processing kernels
+// -----------------------
+
+static inline auto wrap(int value, int size) -> int {
+  value %= size;
+  return value < 0 ? value + size : value;
+}
+
+// 3x3 blur (1 2 1 / 2 4 2 / 1 2 1) / 16 or edge (8 centre, -1 around),
+// on the pixel at `c` with neighbours at `l` and `r` on rows up/mid/down
+static inline auto kernel_pixel(
+  int mode, const std::uint32_t* up, const std::uint32_t* mid,
+  const std::uint32_t* down, int l, int c, int r) -> std::uint32_t
+{
+  std::uint32_t out = OPAQUE_BLACK;
+  for (int shift = 0; shift < 24; shift += 8) {
+    auto ch = [shift](std::uint32_t p) { return static_cast<int>((p >> shift) & 0xFF); };
+    int corners = ch(up[l]) + ch(up[r]) + ch(down[l]) + ch(down[r]);
+    int edges   = ch(up[c]) + ch(down[c]) + ch(mid[l]) + ch(mid[r]);
+    int centre  = ch(mid[c]);
+    int value = mode == POST_BLUR
+      ? (corners + 2 * edges + 4 * centre) >> 4
+      : std::clamp(8 * centre - corners - edges, 0, 255);
+    out |= static_cast<std::uint32_t>(value) << shift;
+  }
+  return out;
+}
+
+#if defined(__SSE2__)
+// kernel_pixel for four consecutive pixels starting at `c`, whose
+// neighbourhoods must not wrap
+static inline auto kernel_pixel4(
+  int mode, const std::uint32_t* up, const std::uint32_t* mid,
+  const std::uint32_t* down, int l, int c, int r) -> __m128i
+{
+  const __m128i zero = _mm_setzero_si128();
+  auto load = [](const std::uint32_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  };
+  __m128i corner_a = load(up + l),   corner_b = load(up + r);
+  __m128i corner_c = load(down + l), corner_d = load(down + r);
+  __m128i edge_a   = load(up + c),   edge_b   = load(down + c);
+  __m128i edge_c   = load(mid + l),  edge_d   = load(mid + r);
+  __m128i centre   = load(mid + c);
+
+  auto half = [&](auto unpack) {
+    __m128i corners = _mm_add_epi16(
+      _mm_add_epi16(unpack(corner_a, zero), unpack(corner_b, zero)),
+      _mm_add_epi16(unpack(corner_c, zero), unpack(corner_d, zero)));
+    __m128i edges = _mm_add_epi16(
+      _mm_add_epi16(unpack(edge_a, zero), unpack(edge_b, zero)),
+      _mm_add_epi16(unpack(edge_c, zero), unpack(edge_d, zero)));
+    __m128i middle = unpack(centre, zero);
+    if (mode == POST_BLUR)
+      return _mm_srli_epi16(
+        _mm_add_epi16(_mm_add_epi16(corners, _mm_slli_epi16(edges, 1)),
+                      _mm_slli_epi16(middle, 2)), 4);
+    return _mm_sub_epi16(_mm_slli_epi16(middle, 3), _mm_add_epi16(corners, edges));
+  };
+  __m128i lo = half([](__m128i a, __m128i b) { return _mm_unpacklo_epi8(a, b); });
+  __m128i hi = half([](__m128i a, __m128i b) { return _mm_unpackhi_epi8(a, b); });
+  return _mm_or_si128(
+    _mm_packus_epi16(lo, hi), _mm_set1_epi32(static_cast<int>(OPAQUE_BLACK)));
+}
+#endif
+
+// Applies the 3x3 kernel to source pixels [begin, end) of one row, which
+// must not wrap themselves; only border neighbourhoods wrap.
+static void kernel_run(
+  int mode, std::uint32_t* out, const std::uint32_t* up,
+  const std::uint32_t* mid, const std::uint32_t* down,
+  int begin, int end, int kx, int width)
+{
+  int c = begin;
+  for (; c < end && c < kx; ++c)
+    *out++ = kernel_pixel(mode, up, mid, down, wrap(c - kx, width), c, c + kx);
+#if defined(__SSE2__)
+  for (; c + 4 <= end && c + 3 + kx < width; c += 4, out += 4)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                     kernel_pixel4(mode, up, mid, down, c - kx, c, c + kx));
+#endif
+  for (; c < end; ++c)
+    *out++ = kernel_pixel(mode, up, mid, down, wrap(c - kx, width), c, wrap(c + kx, width));
+}
+
+// SoftwareRenderer
+// ----------------
+
+SoftwareRenderer::SoftwareRenderer(int width, int height, unsigned int threads)
+  : width(width), height(height), pool(threads), textures(), glyphs(),
+    particles(PARTICLE_COUNT), quads(), lives(), scene(), target(nullptr), post()
+{
+  scene.resize(width, height);
+  quads.reserve(1024 + PARTICLE_COUNT);
+}
+
+auto SoftwareRenderer::load_textures(const char* directory) -> bool {
+  const char* files[SPRITES] = {
+    "background.jpg",
+    "block.png",
+    "block_solid.png",
+    "paddle.png",
+    "awesomeface.png",
+    "particle.png",
+    // in PowerUpType order
+    "powerup_speed.png",
+    "powerup_sticky.png",
+    "powerup_passthrough.png",
+    "powerup_increase.png",
+    "powerup_confuse.png",
+    "powerup_chaos.png"
+  };
+  bool ok = true;
+  for (int i = 0; i < SPRITES; ++i)
+    ok &= load_soft_image((std::string(directory) + "/" + files[i]).c_str(), textures[i]);
+  return ok;
+}
+
+auto SoftwareRenderer::load_font(const char* file, unsigned int size) -> bool {
+  FT_Library library;
+  if (FT_Init_FreeType(&library)) {
+    std::cout << "ERROR::SOFTWARE_RENDERER: Could not init FreeType" << std::endl;
+    return false;
+  }
+  FT_Face face;
+  if (FT_New_Face(library, file, 0, &face)) {
+    std::cout << "ERROR::SOFTWARE_RENDERER: Failed to load font " << file << std::endl;
+    FT_Done_FreeType(library);
+    return false;
+  }
+  FT_Set_Pixel_Sizes(face, 0, size);
+  for (unsigned int c = 0; c < glyphs.size(); ++c) {
+    if (FT_Load_Char(face, c, FT_LOAD_RENDER))
+      continue;
+    const FT_Bitmap& bitmap = face->glyph->bitmap;
+    Glyph& glyph = glyphs[c];
+    glyph.image.width  = bitmap.width;
+    glyph.image.height = bitmap.rows;
+    glyph.image.opaque = false;
+    glyph.image.pixels.resize(static_cast<std::size_t>(bitmap.width) * bitmap.rows);
+    for (unsigned int y = 0; y < bitmap.rows; ++y)
+      for (unsigned int x = 0; x < bitmap.width; ++x)
+        glyph.image.row(y)[x] = 0x00FFFFFFu
+          | static_cast<std::uint32_t>(bitmap.buffer[y * bitmap.pitch + x]) << 24;
+    glyph.bearing_x = face->glyph->bitmap_left;
+    glyph.bearing_y = face->glyph->bitmap_top;
+    glyph.advance   = face->glyph->advance.x >> 6;
+  }
+  FT_Done_Face(face);
+  FT_Done_FreeType(library);
+  return true;
+}
+
+void SoftwareRenderer::update_particles(
+  SpscQueue<GameEvent, 256>& events, const WorldSnapshot& world, float alpha, float dt)
+{
+  GameEvent event;
+  while (events.pop(event)) {
+    pgl::GameObject origin;
+    origin.position = event.position;
+    particles.update(0.0f, origin, BURST_PARTICLES, event.size / 2.0f);
+  }
+  if (world.state == GAME_ACTIVE || world.state == GAME_MENU) {
+    BallObject ball = world.ball;
+    ball.position = world.ball_previous + (world.ball.position - world.ball_previous) * alpha;
+    particles.update(dt, ball, ball.stuck ? 0 : TRAIL_PARTICLES, pgl::float2(ball.radius / 2.0f));
+  }
+}
+
+void SoftwareRenderer::render(
+  const WorldSnapshot& world, float alpha, float time, SoftImage& frame)
+{
+  draw_scene(world, alpha);
+  post_process(world.effects, time, frame);
+  draw_text(world, frame);
+}
+
+void SoftwareRenderer::draw_scene(const WorldSnapshot& world, float alpha) {
+  quads.clear();
+  // like Game::render, the scene is only drawn while playing or in the menu
+  if (world.state == GAME_ACTIVE || world.state == GAME_MENU) {
+    pgl::float3 white(1.0f);
+    quads.push_back({&textures[SPRITE_BACKGROUND], 0.0f, 0.0f,
+                     static_cast<float>(width), static_cast<float>(height), white});
+
+    for (const pgl::GameObject& brick : world.bricks) {
+      if (!brick.destroyed)
+        quads.push_back({&textures[brick.is_solid ? SPRITE_BLOCK_SOLID : SPRITE_BLOCK],
+                         brick.position.x, brick.position.y,
+                         brick.size.x, brick.size.y, brick.color});
+    }
+
+    pgl::float2 player = world.player_previous
+      + (world.player.position - world.player_previous) * alpha;
+    quads.push_back({&textures[SPRITE_PADDLE], player.x, player.y,
+                     world.player.size.x, world.player.size.y, world.player.color});
+
+    // particle.vs draws them 10 units wide
+    for (const ParticlePool::Particle& particle : particles.particles()) {
+      if (particle.life > 0.0f)
+        quads.push_back({&textures[SPRITE_PARTICLE], particle.position.x, particle.position.y,
+                         10.0f, 10.0f, pgl::float3(particle.r, particle.g, particle.b),
+                         particle.a, true});
+    }
+
+    for (const PowerUp& powerUp : world.power_ups) {
+      if (!powerUp.destroyed)
+        quads.push_back({&textures[SPRITE_POWERUP + static_cast<int>(powerUp.Type)],
+                         powerUp.position.x, powerUp.position.y,
+                         powerUp.size.x, powerUp.size.y, powerUp.color});
+    }
+
+    pgl::float2 ball = world.ball_previous
+      + (world.ball.position - world.ball_previous) * alpha;
+    quads.push_back({&textures[SPRITE_FACE], ball.x, ball.y,
+                     world.ball.size.x, world.ball.size.y, world.ball.color});
+  }
+
+  target = &scene;
+  pool.run(height, &SoftwareRenderer::scene_band, this);
+}
+
+void SoftwareRenderer::scene_band(void* context, int begin, int end) {
+  auto* self = static_cast<SoftwareRenderer*>(context);
+  SoftImage& dst = *self->target;
+  for (int y = begin; y < end; ++y)
+    std::fill_n(dst.row(y), dst.width, OPAQUE_BLACK);
+  for (const Quad& quad : self->quads)
+    blit(dst, *quad.texture, quad.x, quad.y, quad.w, quad.h, quad.tint, begin, end,
+         quad.alpha, quad.additive);
+}
+
+void SoftwareRenderer::post_process(
+  const EffectState& effects, float time, SoftImage& frame)
+{
+  if (frame.width != width || frame.height != height)
+    frame.resize(width, height);
+
+  PostParameters p{};
+  p.mode = effects.chaos   ? POST_EDGE
+         : effects.confuse ? POST_INVERT
+         : effects.shake   ? POST_BLUR
+         : POST_COPY;
+  p.mirror = effects.confuse && !effects.chaos;
+  // postprocessor.vs works in texture/NDC units with y up; convert to
+  // whole pixels with y down
+  if (effects.chaos) {
+    p.shift_x =  static_cast<int>(std::lround(std::sin(time) * 0.3f * width));
+    p.shift_y = -static_cast<int>(std::lround(std::cos(time) * 0.3f * height));
+  }
+  if (effects.shake) {
+    p.quad_x =  static_cast<int>(std::lround(std::cos(time * 10.0f) * 0.005f * width));
+    p.quad_y = -static_cast<int>(std::lround(std::cos(time * 15.0f) * 0.005f * height));
+  }
+  // kernel offsets are 1/300 of the texture
+  p.kernel_x = std::max(1, static_cast<int>(std::lround(width / 300.0f)));
+  p.kernel_y = std::max(1, static_cast<int>(std::lround(height / 300.0f)));
+
+  post   = p;
+  target = &frame;
+  pool.run(height, &SoftwareRenderer::post_band, this);
+}
+
+void SoftwareRenderer::post_band(void* context, int begin, int end) {
+  auto* self = static_cast<SoftwareRenderer*>(context);
+  for (int y = begin; y < end; ++y)
+    self->post_row(self->post, self->target->row(y), y);
+}
+
+void SoftwareRenderer::post_row(
+  const PostParameters& p, std::uint32_t* out, int y) const
+{
+  // shake moves the whole quad; what it uncovers stays black
+  int py = y - p.quad_y;
+  if (py < 0 || py >= height) {
+    std::fill_n(out, width, OPAQUE_BLACK);
+    return;
+  }
+  int x_begin = std::max(0, p.quad_x);
+  int x_end   = std::min(width, width + p.quad_x);
+  std::fill_n(out, x_begin, OPAQUE_BLACK);
+  std::fill_n(out + x_end, width - x_end, OPAQUE_BLACK);
+  out += x_begin;
+  int px = x_begin - p.quad_x;
+  int n  = x_end - x_begin;
+
+  if (p.mirror) {
+    // confuse: both axes flipped, colours inverted
+    const std::uint32_t* src = scene.row(height - 1 - py) + (width - 1 - px);
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i invert = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i opaque = _mm_set1_epi32(static_cast<int>(OPAQUE_BLACK));
+    for (; i + 4 <= n; i += 4) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src - i - 3));
+      v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+      v = _mm_or_si128(_mm_xor_si128(v, invert), opaque);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+    }
+#endif
+    for (; i < n; ++i)
+      out[i] = (src[-i] ^ 0x00FFFFFFu) | OPAQUE_BLACK;
+    return;
+  }
+
+  // chaos scrolls the texture coordinates, which repeat
+  int sy = wrap(py + p.shift_y, height);
+  int sx = wrap(px + p.shift_x, width);
+  const std::uint32_t* mid = scene.row(sy);
+
+  if (p.mode == POST_COPY) {
+    while (n > 0) {
+      int run = std::min(n, width - sx);
+      std::memcpy(out, mid + sx, run * sizeof(std::uint32_t));
+      out += run;
+      n   -= run;
+      sx   = 0;
+    }
+    return;
+  }
+
+  const std::uint32_t* up   = scene.row(wrap(sy - p.kernel_y, height));
+  const std::uint32_t* down = scene.row(wrap(sy + p.kernel_y, height));
+  while (n > 0) {
+    int run = std::min(n, width - sx);
+    kernel_run(p.mode, out, up, mid, down, sx, sx + run, p.kernel_x, width);
+    out += run;
+    n   -= run;
+    sx   = 0;
+  }
+}
+
+// pgl::ui::TextRenderer::render_text: `y` is the top of the line, glyphs
+// hang from the height of 'H'
+void SoftwareRenderer::draw_text(const WorldSnapshot& world, SoftImage& frame) {
+  std::array<TextLine, 2> lines;
+  unsigned int count = frame_text(world, height, lives, lines);
+  for (unsigned int i = 0; i < count; ++i) {
+    const TextLine& line = lines[i];
+    float x = line.x;
+    for (char c : *line.text) {
+      const Glyph& glyph = glyphs[static_cast<unsigned char>(c) % glyphs.size()];
+      float left = x + glyph.bearing_x * line.scale;
+      float top  = line.y + (glyphs['H'].bearing_y - glyph.bearing_y) * line.scale;
+      blit(frame, glyph.image, left, top, glyph.image.width * line.scale,
+           glyph.image.height * line.scale, line.color, 0, frame.height);
+      x += glyph.advance * line.scale;
+    }
+  }
+}
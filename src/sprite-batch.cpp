@@ -0,0 +1,114 @@
+#include <breakout/sprite-batch.hpp>
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+// no texture bound yet
+const unsigned int NO_PAGE = ~0u;
+
+SpriteBatch::SpriteBatch(pgl::Shader shader, const TextureAtlas& atlas, std::size_t capacity)
+  : shader(shader.id), atlas(atlas), capacity(capacity), instances(),
+    vao(0), quad_vbo(0), instance_vbo(0), page(NO_PAGE), bound(NO_PAGE), counters()
+{
+  instances.reserve(capacity);
+
+  // unit quad as a triangle strip, (0, 0) at the top left
+  float corners[] = { 0.0f, 0.0f,  1.0f, 0.0f,  0.0f, 1.0f,  1.0f, 1.0f };
+  glGenVertexArrays(1, &vao);
+  glGenBuffers(1, &quad_vbo);
+  glGenBuffers(1, &instance_vbo);
+  glBindVertexArray(vao);
+
+  glBindBuffer(GL_ARRAY_BUFFER, quad_vbo);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*) 0);
+
+  glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+  glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*) offsetof(Instance, x));
+  glVertexAttribDivisor(1, 1);
+  glEnableVertexAttribArray(2);
+  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*) offsetof(Instance, u0));
+  glVertexAttribDivisor(2, 1);
+  glEnableVertexAttribArray(3);
+  glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*) offsetof(Instance, r));
+  glVertexAttribDivisor(3, 1);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+
+  configure_program();
+}
+
+SpriteBatch::~SpriteBatch() {
+  glDeleteBuffers(1, &instance_vbo);
+  glDeleteBuffers(1, &quad_vbo);
+  glDeleteVertexArrays(1, &vao);
+}
+
+void SpriteBatch::set_program(unsigned int program) {
+  shader = ShaderProgram(program);
+  configure_program();
+}
+
+void SpriteBatch::configure_program() {
+  shader.use();
+  shader.set(shader.location("image"), 0);
+  shader.bind_block("Frame", FRAME_BINDING);
+}
+
+void SpriteBatch::begin() {
+  counters = BatchStats();
+  instances.clear();
+  page = NO_PAGE;
+  // other renderers may have rebound unit 0 since the last frame
+  invalidate();
+}
+
+void SpriteBatch::invalidate() {
+  bound = NO_PAGE;
+}
+
+void SpriteBatch::draw(unsigned int id, pgl::float2 position, pgl::float2 size, pgl::float3 color) {
+  const AtlasRegion& region = atlas.region(id);
+  if (region.page != page || instances.size() == capacity) {
+    flush();
+    page = region.page;
+  }
+
+  instances.push_back({ position.x, position.y, size.x, size.y,
+                        region.u0, region.v0, region.u1, region.v1,
+                        color.x, color.y, color.z });
+  ++counters.sprites;
+}
+
+void SpriteBatch::flush() {
+  if (instances.empty())
+    return;
+
+  shader.use();
+  if (bound != page) {
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlas.page_texture(page));
+    bound = page;
+    ++counters.binds;
+    count_call(CALL_TEXTURE);
+  }
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+  // orphan the previous contents so the driver doesn't wait on the GPU
+  glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(Instance), instances.data());
+  glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instances.size());
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+  ++counters.draws;
+  count_call(CALL_BIND);
+  count_call(CALL_UPLOAD, 2);
+  count_call(CALL_DRAW);
+
+  instances.clear();
+}
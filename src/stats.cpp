@@ -0,0 +1,35 @@
+#include <breakout/stats.hpp>
+
+#include <cmath>
+
+RunningStats::RunningStats()
+  : n(0), m(0.0), s(0.0), lo(0.0), hi(0.0)
+{
+
+}
+
+void RunningStats::add(double sample) {
+  if (n == 0) {
+    lo = hi = sample;
+  } else {
+    if (sample < lo) lo = sample;
+    if (sample > hi) hi = sample;
+  }
+  ++n;
+  double delta = sample - m;
+  m += delta / n;
+  s += delta * (sample - m);
+}
+
+void RunningStats::clear() {
+  n = 0;
+  m = s = lo = hi = 0.0;
+}
+
+auto RunningStats::variance() const -> double {
+  return n > 1 ? s / (n - 1) : 0.0;
+}
+
+auto RunningStats::stddev() const -> double {
+  return std::sqrt(variance());
+}
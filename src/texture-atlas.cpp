@@ -0,0 +1,106 @@
+#include <breakout/texture-atlas.hpp>
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+TextureAtlas::TextureAtlas(int page_size, int padding)
+  : page_size(page_size), padding(padding),
+    names(), images(), regions(), pages(), textures()
+{
+
+}
+
+auto TextureAtlas::add(const std::string& name, SoftImage image) -> unsigned int {
+  names.push_back(name);
+  images.push_back(std::move(image));
+  regions.push_back(AtlasRegion());
+  return images.size() - 1;
+}
+
+auto TextureAtlas::add(const std::string& name, const char* file, bool alpha) -> unsigned int {
+  SoftImage image;
+  load_soft_image(file, image);
+  if (!alpha && !image.opaque) {
+    for (std::uint32_t& texel : image.pixels)
+      texel |= 0xFF000000u;
+    image.opaque = true;
+  }
+  return add(name, std::move(image));
+}
+
+void TextureAtlas::pack() {
+  pages.clear();
+
+  std::vector<unsigned int> order(images.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) {
+    return images[a].height > images[b].height;
+  });
+
+  // shelves are filled left to right; a new shelf opens under the tallest
+  // image of the previous one, a new page when the shelf doesn't fit
+  int x = 0, y = 0, shelf = 0;
+  for (unsigned int id : order) {
+    const SoftImage& image = images[id];
+    int w = image.width + 2 * padding;
+    int h = image.height + 2 * padding;
+    if (w > page_size || h > page_size) {
+      std::cout << "ERROR::ATLAS: " << names[id] << " doesn't fit in a "
+                << page_size << "x" << page_size << " page" << std::endl;
+      continue;
+    }
+    if (x + w > page_size) {
+      x = 0;
+      y += shelf;
+      shelf = 0;
+    }
+    if (pages.empty() || y + h > page_size) {
+      pages.emplace_back();
+      pages.back().resize(page_size, page_size);
+      x = y = shelf = 0;
+    }
+    blit(pages.back(), image, x + padding, y + padding);
+
+    AtlasRegion& region = regions[id];
+    region.page = pages.size() - 1;
+    region.u0 = float(x + padding) / page_size;
+    region.v0 = float(y + padding) / page_size;
+    region.u1 = float(x + padding + image.width) / page_size;
+    region.v1 = float(y + padding + image.height) / page_size;
+
+    x += w;
+    shelf = std::max(shelf, h);
+  }
+  // the CPU copies of the sources are not needed anymore
+  images.clear();
+  images.shrink_to_fit();
+}
+
+void TextureAtlas::blit(SoftImage& page, const SoftImage& image, int x, int y) {
+  if (image.width == 0 || image.height == 0)
+    return;
+  for (int row = -padding; row < image.height + padding; ++row) {
+    const std::uint32_t* src = image.row(std::clamp(row, 0, image.height - 1));
+    std::uint32_t* dst = page.row(y + row) + x;
+    for (int col = -padding; col < image.width + padding; ++col)
+      dst[col] = src[std::clamp(col, 0, image.width - 1)];
+  }
+}
+
+void TextureAtlas::upload() {
+  textures.resize(pages.size());
+  glGenTextures(textures.size(), textures.data());
+  for (unsigned int i = 0; i < pages.size(); ++i) {
+    glBindTexture(GL_TEXTURE_2D, textures[i]);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, pages[i].width, pages[i].height,
+                 0, GL_RGBA, GL_UNSIGNED_BYTE, pages[i].pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
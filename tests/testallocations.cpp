@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <breakout/game.hpp>
+
+#include <breakout/alloc-tracker.hpp>
+
+// Built against game-utils-tracked, which always counts allocations.
+#ifndef BREAKOUT_TRACK_ALLOCATIONS
+#error "link against game-utils-tracked"
+#endif
+
+// A gameplay tick once the game is warmed up (containers at capacity,
+// power-ups in flight) must not touch the heap. Sound is muted, as in
+// every headless replay; in a game it is billed to its own phase since
+// irrKlang allocates internally.
+TEST(Allocations, SteadyStateTickDoesNotAllocate) {
+  Game game(800, 600);
+  game.muted = true;
+  game.init_world();
+  game.autopilot = true;
+  game.state = GAME_ACTIVE;
+  ASSERT_FALSE(game.bricks().empty()) << "level data not found";
+
+  WorldSnapshot world;
+  const float dt = 1.0f / 120.0f;
+  double time = 0.0;
+  auto tick = [&] {
+    time += dt;
+    game.process_input(dt, time);
+    game.update(dt);
+    game.snapshot(world, time);
+  };
+
+  for (int i = 0; i < 1200; ++i)
+    tick();
+
+  AllocationCounts before = allocation_counts("tick");
+  for (int i = 0; i < 1200; ++i) {
+    AllocationScope scope("tick");
+    tick();
+  }
+  AllocationCounts after = allocation_counts("tick");
+
+  EXPECT_EQ(after.count, before.count);
+  EXPECT_EQ(after.bytes, before.bytes);
+}
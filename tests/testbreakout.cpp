@@ -1,3 +1,195 @@
 #include <gtest/gtest.h>
-#include <game/game.hpp>
+#include <breakout/game.hpp>
 
+#include <breakout/session.hpp>
+#include <breakout/fixed-physics.hpp>
+#include <breakout/dynamic-resolution.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+// perf-regress compares runs of the same sessions, so a replay has to
+// play out the same game every time.
+TEST(Sessions, ReplayIsDeterministic) {
+  Session session;
+  ASSERT_TRUE(load_session("../resources/sessions/level-two.ses", session));
+  ASSERT_FALSE(session.events.empty());
+
+  auto play = [&session] {
+    Game game(800, 600);
+    game.muted = true;
+    game.init_world();
+    SessionReplay replay(game, session);
+    while (replay.tick())
+      ;
+    std::size_t destroyed = std::count_if(
+      game.bricks().begin(), game.bricks().end(),
+      [](const pgl::GameObject& brick) { return brick.destroyed; });
+    return std::make_tuple(destroyed, game.lives, game.level, game.state);
+  };
+
+  EXPECT_EQ(play(), play());
+}
+
+// The fixed-point circle/box test must find the same contacts, in the
+// same directions, as the float one it replaces.
+TEST(FixedPoint, CollisionsMatchFloat) {
+  Game game(800, 600);
+  game.init_world();
+  ASSERT_FALSE(game.bricks().empty()) << "level data not found";
+
+  BallObject ball;
+  unsigned int hits = 0;
+  for (float y = 0.0f; y < 300.0f; y += 1.7f) {
+    for (float x = 0.0f; x < 800.0f; x += 2.3f) {
+      ball.position = pgl::float2(x, y);
+      for (pgl::GameObject& brick : game.bricks()) {
+        Collision expected = CheckCollision(ball, brick);
+        Collision actual   = fixed_check_collision(ball, brick);
+        ASSERT_EQ(std::get<0>(actual), std::get<0>(expected)) << x << ", " << y;
+        if (std::get<0>(expected)) {
+          EXPECT_EQ(std::get<1>(actual), std::get<1>(expected)) << x << ", " << y;
+          ++hits;
+        }
+      }
+    }
+  }
+  EXPECT_GT(hits, 0u);
+}
+
+// The autopilot steers fixed-point games from the integer predictor, which
+// has to agree with the float one it mirrors.
+TEST(FixedPoint, LandingMatchesFloat) {
+  Game game(800, 600);
+  game.init_world();
+  ASSERT_FALSE(game.bricks().empty()) << "level data not found";
+
+  const float radius = 12.5f, paddle_line = 580.0f - 2.0f * radius;
+  unsigned int queries = 0, agreed = 0;
+  for (float x = 10.0f; x < 770.0f; x += 37.0f) {
+    for (float angle = -2.5f; angle <= 2.5f; angle += 0.5f) {
+      pgl::float2 position(x, 400.0f), velocity(100.0f * angle, -250.0f);
+      Prediction expected = predict_landing(position, velocity, radius, false,
+                                            game.bricks(), 800.0f, paddle_line);
+      FixedPrediction actual = predict_landing_fixed(
+        Fixed2::from_float(position), Fixed2::from_float(velocity), Fixed::from_float(radius),
+        false, game.bricks(), Fixed::from_int(800), Fixed::from_float(paddle_line));
+      ++queries;
+      // a path grazing a brick corner may go either way
+      agreed += actual.valid == expected.valid
+             && std::abs(actual.x.to_float() - expected.x) < 0.5f;
+    }
+  }
+  EXPECT_GE(agreed, queries * 95 / 100);
+}
+
+// The merged colliders of a level must cover its solid bricks exactly:
+// every solid brick lies inside one collider and the areas add up.
+TEST(Levels, MergedCollidersCoverSolidBricks) {
+  Game game(800, 600);
+  game.init_world();
+  for (const GameLevel& level : game.levels) {
+    ASSERT_FALSE(level.bricks.empty()) << "level data not found";
+    EXPECT_LE(level.colliders.size(), level.solid_count);
+
+    float solid_area = 0.0f, collider_area = 0.0f;
+    for (const pgl::GameObject& brick : level.bricks) {
+      if (!brick.is_solid)
+        continue;
+      solid_area += brick.size.x * brick.size.y;
+      unsigned int inside = 0;
+      for (const pgl::GameObject& box : level.colliders)
+        inside += brick.position.x >= box.position.x
+               && brick.position.y >= box.position.y
+               && brick.position.x + brick.size.x <= box.position.x + box.size.x
+               && brick.position.y + brick.size.y <= box.position.y + box.size.y;
+      EXPECT_EQ(inside, 1u) << brick.position.x << ", " << brick.position.y;
+    }
+    for (const pgl::GameObject& box : level.colliders)
+      collider_area += box.size.x * box.size.y;
+    EXPECT_NEAR(collider_area, solid_area, 1e-3f * solid_area);
+  }
+}
+
+// The level parser takes the files' trailing whitespace and blank lines,
+// and rejects rows it can't read whole or of the wrong width.
+TEST(Levels, ParserRejectsMalformedRows) {
+  auto parse = [](const std::string& text, LevelTiles& tiles) {
+    return parse_level(text.data(), text.data() + text.size(), "test.lvl", tiles);
+  };
+  LevelTiles tiles;
+  ASSERT_TRUE(parse("1 0 5 \t \r\n\n2 3 4\n300 0 1", tiles));
+  EXPECT_EQ(tiles.width, 3u);
+  EXPECT_EQ(tiles.height, 3u);
+  EXPECT_EQ(tiles.bricks, 7u);
+  EXPECT_EQ(tiles.at(0, 1), 2u);
+  EXPECT_EQ(tiles.at(0, 2), 255u);
+
+  EXPECT_FALSE(parse("1 1 1\n1 1\n", tiles));
+  EXPECT_FALSE(parse("1 1 1\n1 x 1\n", tiles));
+  EXPECT_FALSE(parse("1 1 1\n1 -1 1\n", tiles));
+  EXPECT_FALSE(parse("1 2,3\n", tiles));
+  EXPECT_FALSE(parse("99999999999 1\n", tiles));
+  EXPECT_FALSE(parse(" \n\n", tiles));
+}
+
+// A level with more rows than pixels of height still fills the area:
+// its bricks are thin, not flat.
+TEST(Levels, TallLevelKeepsBrickHeight) {
+  std::string file = (std::filesystem::temp_directory_path() / "tall.lvl").string();
+  {
+    std::ofstream out(file);
+    for (int row = 0; row < 400; ++row)
+      out << "1 2\n";
+  }
+  GameLevel level;
+  ASSERT_TRUE(level.load(file.c_str(), 800, 300));
+  std::filesystem::remove(file);
+  ASSERT_EQ(level.bricks.size(), 800u);
+  EXPECT_GT(level.bricks.front().size.y, 0.0f);
+  const pgl::GameObject& last = level.bricks.back();
+  EXPECT_NEAR(last.position.y + last.size.y, 300.0f, 1e-3f);
+  ASSERT_FALSE(level.colliders.empty());
+  EXPECT_NEAR(level.colliders.back().position.y + level.colliders.back().size.y, 300.0f, 1e-3f);
+}
+
+// The latency histogram's percentiles follow the latest samples only,
+// while its totals keep everything.
+TEST(Latency, HistogramRollsOver) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.percentile(0.5), 0.0);
+  for (unsigned int i = 0; i < LatencyHistogram::window; ++i)
+    histogram.add(0.0305);
+  EXPECT_DOUBLE_EQ(histogram.percentile(0.99), 0.031);
+  for (unsigned int i = 0; i < LatencyHistogram::window; ++i)
+    histogram.add(i % 10 == 0 ? 0.5 : 0.0121);
+  EXPECT_DOUBLE_EQ(histogram.percentile(0.5), 0.013);
+  EXPECT_DOUBLE_EQ(histogram.percentile(0.99), LatencyHistogram::buckets / 1000.0);
+  EXPECT_EQ(histogram.recent(30), 0u);
+  EXPECT_EQ(histogram.total(30), LatencyHistogram::window);
+  EXPECT_EQ(histogram.count(), 2 * LatencyHistogram::window);
+}
+
+// With GPU time proportional to the pixel count, the controller has to
+// settle on a scale within budget and stay there.
+TEST(DynamicResolution, ControllerHoldsBudget) {
+  const double budget = 0.008;
+  const double full_scale_time = 0.016;
+  ResolutionController controller(budget, 0.5f, 1.0f);
+
+  float scale = controller.scale();
+  for (int frame = 0; frame < 600; ++frame)
+    scale = controller.update(full_scale_time * scale * scale);
+  EXPECT_LE(full_scale_time * scale * scale, budget);
+  EXPECT_GT(scale, 0.5f);
+
+  float settled = scale;
+  for (int frame = 0; frame < 600; ++frame)
+    scale = controller.update(full_scale_time * scale * scale);
+  EXPECT_EQ(scale, settled);
+
+  // the load drops: the scale goes back up to full resolution
+  for (int frame = 0; frame < 600; ++frame)
+    scale = controller.update(0.25 * full_scale_time * scale * scale);
+  EXPECT_EQ(scale, 1.0f);
+}